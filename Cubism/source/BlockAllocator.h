@@ -0,0 +1,220 @@
+/*
+ *  BlockAllocator.h
+ *  Cubism
+ *
+ */
+#pragma once
+
+#include <cstdlib>
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <map>
+#include <algorithm>
+
+#if defined(_USE_HUGEPAGES_) || defined(_USE_NUMA_)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef _USE_NUMA_
+#include <numa.h>
+#include <omp.h>
+#endif
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+/**
+ * Placement of the blocks of a grid on the NUMA domains (numa=1): the blocks
+ * [first(d, N), first(d+1, N)) of the storage, i.e. of Grid::getBlocksInfo(), are on domain d.
+ * OpenMP thread tid runs on domain(tid), as set by bind() in the parallel regions.
+ * Without numa=1 there is one domain.
+ */
+struct NUMAPartition
+{
+	static int domains()
+	{
+#ifdef _USE_NUMA_
+		return std::max(1, numa_num_configured_nodes());
+#else
+		return 1;
+#endif
+	}
+
+#ifdef _USE_NUMA_
+	static int domain(const int tid)
+	{
+		const int cores_per_node = std::max(1, numa_num_configured_cpus() / domains());
+
+		return std::min(tid / cores_per_node, domains() - 1);
+	}
+#else
+	static int domain(const int) { return 0; }
+#endif
+
+	static size_t first(const int d, const size_t n)
+	{
+		return n * d / domains();
+	}
+
+	//runs the calling OpenMP thread on its domain, at the start of the parallel regions
+	static void bind()
+	{
+#ifdef _USE_NUMA_
+		numa_run_on_node(domain(omp_get_thread_num()));
+#endif
+	}
+};
+
+/**
+ * Allocator of the blocks of a grid. Arrays of at least LARGE bytes are mapped:
+ * - hugepages=1: on 1 GB pages if they are that large, on 2 MB pages otherwise (MAP_HUGETLB,
+ *   pages reserved in /proc/sys/vm/nr_hugepages). If none is left, they are mapped
+ *   with 4 KB pages and advised as transparent huge pages
+ * - numa=1: the elements of NUMA domain d (see NUMAPartition) are bound to d before they are touched.
+ * Everything else (the labs, the small grids, both flags off) is taken from posix_memalign, aligned as T.
+ */
+template<typename T>
+class BlockAllocator
+{
+	enum { LARGE = 2 << 20 };
+
+	//mapped arrays and their mapped size, released with munmap
+	static std::map<void *, size_t>& _mapped()
+	{
+		static std::map<void *, size_t> mapped;
+
+		return mapped;
+	}
+
+#if defined(_USE_HUGEPAGES_) || defined(_USE_NUMA_)
+	static void * _map(const size_t bytes, size_t& mapped, size_t& pagesize)
+	{
+		const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef _USE_HUGEPAGES_
+		const size_t pagesizes[2] = { (size_t)1 << 30, (size_t)2 << 20 };
+		const int pageshifts[2] = { 30, 21 };
+
+		for(int i=0; i<2; i++)
+		{
+			if (bytes < pagesizes[i] && i == 0) continue;
+
+			mapped = (bytes + pagesizes[i] - 1) / pagesizes[i] * pagesizes[i];
+			pagesize = pagesizes[i];
+
+			void * const p = mmap(NULL, mapped, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB | (pageshifts[i] << MAP_HUGE_SHIFT), -1, 0);
+
+			if (p != MAP_FAILED) return p;
+		}
+#endif
+		pagesize = sysconf(_SC_PAGESIZE);
+		mapped = (bytes + pagesize - 1) / pagesize * pagesize;
+
+		void * const p = mmap(NULL, mapped, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+		if (p == MAP_FAILED) return NULL;
+
+#if defined(_USE_HUGEPAGES_) && defined(MADV_HUGEPAGE)
+		madvise(p, mapped, MADV_HUGEPAGE);
+#endif
+		return p;
+	}
+#endif
+
+public:
+
+	typedef T value_type;
+	typedef T * pointer;
+	typedef const T * const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<typename U> struct rebind { typedef BlockAllocator<U> other; };
+
+	BlockAllocator() { }
+	BlockAllocator(const BlockAllocator&) { }
+	template<typename U> BlockAllocator(const BlockAllocator<U>&) { }
+
+	pointer allocate(const size_type n, const void * = 0)
+	{
+		const size_t bytes = n * sizeof(T);
+
+#if defined(_USE_HUGEPAGES_) || defined(_USE_NUMA_)
+		if (bytes >= LARGE)
+		{
+			size_t mapped = 0, pagesize = 0;
+			char * const p = (char *)_map(bytes, mapped, pagesize);
+
+			if (p == NULL) throw std::bad_alloc();
+
+#ifdef _USE_NUMA_
+			//whole pages only: a page across two domains goes to the first one
+			for(int d=0; d<NUMAPartition::domains(); d++)
+			{
+				const size_t s = (NUMAPartition::first(d, n) * sizeof(T) + pagesize - 1) / pagesize * pagesize;
+				const size_t e = d + 1 == NUMAPartition::domains() ? mapped :
+					(NUMAPartition::first(d + 1, n) * sizeof(T) + pagesize - 1) / pagesize * pagesize;
+
+				if (e > s) numa_tonode_memory(p + s, e - s, d);
+			}
+#endif
+
+#pragma omp critical (blockallocator)
+			_mapped()[p] = mapped;
+
+			return (pointer)p;
+		}
+#endif
+		void * p = NULL;
+
+		if (posix_memalign(&p, std::max(sizeof(void *), (size_t)__alignof__(T)), std::max(bytes, (size_t)1)) != 0)
+			throw std::bad_alloc();
+
+		return (pointer)p;
+	}
+
+#if defined(_USE_HUGEPAGES_) || defined(_USE_NUMA_)
+	void deallocate(const pointer p, const size_type n)
+	{
+		size_t mapped = 0;
+
+		if (n * sizeof(T) >= LARGE)
+		{
+#pragma omp critical (blockallocator)
+			{
+				const std::map<void *, size_t>::iterator it = _mapped().find((void *)p);
+
+				if (it != _mapped().end())
+				{
+					mapped = it->second;
+					_mapped().erase(it);
+				}
+			}
+		}
+
+		if (mapped)
+		{
+			munmap((void *)p, mapped);
+
+			return;
+		}
+
+		free((void *)p);
+	}
+#else
+	void deallocate(const pointer p, const size_type) { free((void *)p); }
+#endif
+
+	void construct(const pointer p, const T& val) { new((void *)p) T(val); }
+	void destroy(const pointer p) { p->~T(); }
+
+	size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+	bool operator==(const BlockAllocator&) const { return true; }
+	bool operator!=(const BlockAllocator&) const { return false; }
+};
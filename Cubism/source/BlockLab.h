@@ -9,8 +9,14 @@
 //
 #pragma once
 
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
 #include "Matrix3D.h"
 #include "Grid.h"
+#include "BlockLayout.h"
+#include "StencilInfo.h"
 //#include "Concepts.h"
 
 /**
@@ -20,6 +26,8 @@
  * Requirements:
  * - Concepts::BlockLabElementType<ElementTypeT>
  * - Concepts::Castable<typename BlockType::ElementType, ElementTypeT>
+ * An ElementTypeT narrower than the element of the block holds only some of its components
+ * (see prepare(grid, stencil)): it is then an array of Reals, the components are gathered.
  */
 template<typename TBlock, template<typename X> class allocator = std::allocator, typename ElementTypeT = typename TBlock::ElementType>
 class BlockLab
@@ -46,6 +54,28 @@ protected:
 	
 	const Grid<BlockType, allocator>* m_refGrid;
 	
+	//n points of the neighbor block, from point src (ix + sizeX * (iy + sizeY * iz)),
+	//go to the lab from element dst (of the cache block)
+	struct GhostRun { int dst, src, n; };
+	
+	//the ghosts taken from the neighbor at code (-1, 0 or 1 along each direction)
+	struct GhostPlan
+	{
+		int code[3];
+		std::vector<GhostRun> runs;
+	};
+	
+	//built in prepare(): the plans of a block, given its position in the grid
+	//along each direction (0: inside, 1: first, 2: last), see _position()
+	std::vector<GhostPlan> m_plans[27];
+	
+	//index of the block loaded last, see load_xnext()
+	int m_lastIndex[3];
+	
+	//narrower lab elements: the components of the block elements they hold, in this order
+	std::vector<int> m_components;
+	BlockLayout m_layout;
+	
 	virtual void _apply_bc(const BlockInfo& info, const Real t=0) { }
 	
 	template<typename T>
@@ -59,6 +89,209 @@ protected:
 		t = NULL; 
 	}
 	
+	template<bool aos> struct LayoutTag { };
+	struct GatherTag { };
+	
+	template<bool gather, bool aos> struct CopyTraits { typedef LayoutTag<aos> Tag; };
+	template<bool aos> struct CopyTraits<true, aos> { typedef GatherTag Tag; };
+	
+	typedef typename CopyTraits<(sizeof(ElementType) < sizeof(ElementTypeBlock)), BlockLayoutTraits<BlockType>::aos>::Tag CopyTag;
+	
+	//the block is an array of ElementTypeBlock: row by row, from x = x0
+	void _load_block(BlockType& block, LayoutTag<true>, const int x0=0)
+	{
+		assert(sizeof(ElementType) == sizeof(typename BlockType::ElementType));
+		
+		const int nX = BlockType::sizeX;
+		const int nY = BlockType::sizeY;
+		const int nZ = BlockType::sizeZ;
+		
+		ElementTypeBlock * ptrSource = &block(0);
+		
+		for(int iz=0; iz<nZ; iz++)
+			for(int iy=0; iy<nY; iy++)
+			{
+				ElementType * ptrDestination = &m_cacheBlock->Access(0-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]);
+				
+				//for(int ix=0; ix<nX; ix++, ptrSource++, ptrDestination++)
+				//	*ptrDestination = (ElementType)*ptrSource;
+				memcpy(ptrDestination + x0, ptrSource + x0, sizeof(ElementType)*(nX - x0));
+				
+				ptrSource+= nX;
+			}
+	}
+	
+	//a ghost run of the neighbor b: one copy if b is an array of ElementTypeBlock...
+	inline void _copy(BlockType& b, const GhostRun& run, LayoutTag<true>)
+	{
+		memcpy(&m_cacheBlock->LinAccess(run.dst), &b(0) + run.src, sizeof(ElementType) * run.n);
+	}
+	
+	//...point by point otherwise
+	inline void _copy(BlockType& b, const GhostRun& run, LayoutTag<false>)
+	{
+		ElementType * const ptrDestination = &m_cacheBlock->LinAccess(run.dst);
+		
+		const int ix = run.src % BlockType::sizeX;
+		const int iy = (run.src / BlockType::sizeX) % BlockType::sizeY;
+		const int iz = run.src / (BlockType::sizeX * BlockType::sizeY);
+		
+		for(int i=0; i<run.n; i++)
+			ptrDestination[i] = (ElementType)b(ix + i, iy, iz);
+	}
+	
+	//n points of b from point ip: the c-th Real of a lab element is the component m_components[c]
+	inline void _gather(BlockType& b, const int ip, ElementType * const dst, const int n) const
+	{
+		const Real * const src = (const Real *)&b;
+		const int * const components = &m_components.front();
+		const int NC = m_components.size();
+		
+		for(int i=0; i<n; i++)
+		{
+			Real * const d = (Real *)(dst + i);
+			
+			for(int c=0; c<NC; c++)
+				d[c] = src[m_layout.offset(ip + i, components[c])];
+		}
+	}
+	
+	//narrower lab elements: the selected components, whatever the layout
+	inline void _copy(BlockType& b, const GhostRun& run, GatherTag)
+	{
+		_gather(b, run.src, &m_cacheBlock->LinAccess(run.dst), run.n);
+	}
+	
+	static int _position(const int index, const int n)
+	{
+		return index == 0 ? 1 : (index == n - 1 ? 2 : 0);
+	}
+	
+	//the ghost runs of every neighbor code and block position: the neighbor codes
+	//skipped at the non-periodic boundaries and, if not tensorial, edges and corners have no plan
+	void _make_plans()
+	{
+		const int nX = BlockType::sizeX;
+		const int nY = BlockType::sizeY;
+		const int nZ = BlockType::sizeZ;
+		
+		const bool periodic[3] = { is_xperiodic(), is_yperiodic(), is_zperiodic() };
+		
+		for(int ipos=0; ipos<27; ipos++)
+		{
+			const int pos[3] = { ipos%3, (ipos/3)%3, (ipos/9)%3 };
+			
+			m_plans[ipos].clear();
+			
+			for(int icode=0; icode<27; icode++)
+			{
+				if (icode == 1*1 + 3*1 + 9*1) continue;
+				
+				const int code[3] = { icode%3-1, (icode/3)%3-1, (icode/9)%3-1};
+				
+				bool skip = false;
+				for(int d=0; d<3; d++)
+				{
+					const int dskip = pos[d] == 1 ? -1 : 1;
+					
+					skip = skip || (!periodic[d] && code[d] == dskip && pos[d] != 0);
+				}
+				
+				if (skip) continue;
+				
+				if (!istensorial && abs(code[0])+abs(code[1])+abs(code[2])>1) continue;
+				
+				const int s[3] = { 
+					code[0]<1? (code[0]<0 ? m_stencilStart[0]:0 ) : nX, 
+					code[1]<1? (code[1]<0 ? m_stencilStart[1]:0 ) : nY, 
+					code[2]<1? (code[2]<0 ? m_stencilStart[2]:0 ) : nZ };
+				
+				const int e[3] = {
+					code[0]<1? (code[0]<0 ? 0:nX ) : nX+m_stencilEnd[0]-1, 
+					code[1]<1? (code[1]<0 ? 0:nY ) : nY+m_stencilEnd[1]-1, 
+					code[2]<1? (code[2]<0 ? 0:nZ ) : nZ+m_stencilEnd[2]-1};
+				
+				GhostPlan plan;
+				plan.code[0] = code[0];
+				plan.code[1] = code[1];
+				plan.code[2] = code[2];
+				
+				for(int iz=s[2]; iz<e[2]; iz++)
+					for(int iy=s[1]; iy<e[1]; iy++)
+					{
+						const GhostRun run = {
+							(int)(&m_cacheBlock->Access(s[0]-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]) - &m_cacheBlock->LinAccess(0)),
+							s[0] - code[0]*nX + nX * (iy - code[1]*nY + nY * (iz - code[2]*nZ)),
+							e[0] - s[0] };
+						
+						//consecutive runs that are contiguous on both sides are merged
+						GhostRun * const last = plan.runs.empty() ? NULL : &plan.runs.back();
+						
+						if (last != NULL && last->dst + last->n == run.dst && last->src + last->n == run.src)
+							last->n += run.n;
+						else
+							plan.runs.push_back(run);
+					}
+				
+				m_plans[ipos].push_back(plan);
+			}
+		}
+	}
+	
+	//any other layout (see BlockLayout.h): point by point
+	void _load_block(BlockType& block, LayoutTag<false>, const int x0=0)
+	{
+		const int nX = BlockType::sizeX;
+		const int nY = BlockType::sizeY;
+		const int nZ = BlockType::sizeZ;
+		
+		for(int iz=0; iz<nZ; iz++)
+			for(int iy=0; iy<nY; iy++)
+			{
+				ElementType * const ptrDestination = &m_cacheBlock->Access(0-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]);
+				
+				for(int ix=x0; ix<nX; ix++)
+					ptrDestination[ix] = (ElementType)block(ix, iy, iz);
+			}
+	}
+	
+	void _load_block(BlockType& block, GatherTag, const int x0=0)
+	{
+		const int nX = BlockType::sizeX;
+		const int nY = BlockType::sizeY;
+		const int nZ = BlockType::sizeZ;
+		
+		for(int iz=0; iz<nZ; iz++)
+			for(int iy=0; iy<nY; iy++)
+				_gather(block, x0 + nX * (iy + nY * iz), &m_cacheBlock->Access(x0-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]), nX - x0);
+	}
+	
+	//the ghosts of the block, without those below it in z if !lowerzghosts
+	//and without those of its -x neighbor if !xminusghosts
+	void _load_ghosts(const BlockInfo& info, const bool lowerzghosts, const bool xminusghosts=true)
+	{
+		const Grid<BlockType,allocator>& grid = *m_refGrid;
+		
+		const int ipos = _position(info.index[0], NX) + 3 * (_position(info.index[1], NY) + 3 * _position(info.index[2], NZ));
+		const std::vector<GhostPlan>& plans = m_plans[ipos];
+		
+		for(size_t iplan=0; iplan<plans.size(); iplan++)
+		{
+			const GhostPlan& plan = plans[iplan];
+			const int * const code = plan.code;
+			
+			if (!lowerzghosts && code[2]<0) continue;
+			if (!xminusghosts && code[0]<0 && code[1]==0 && code[2]==0) continue;
+			
+			if (!grid.avail(info.index[0] + code[0], info.index[1] + code[1], info.index[2] + code[2])) continue;
+			
+			BlockType& b = grid(info.index[0] + code[0], info.index[1] + code[1], info.index[2] + code[2]);
+			
+			for(size_t irun=0; irun<plan.runs.size(); irun++)
+				_copy(b, plan.runs[irun], CopyTag());
+		}
+	}
+	
 public:
 	
 	BlockLab():
@@ -95,6 +328,19 @@ public:
 		prepare(grid, ss, se, istensorial);
 	}
 	
+	/**
+	 * Prepare the extended block for a stencil. If ElementType is narrower than the element
+	 * of the block, it holds the components stencil.selcomponents only, in this order.
+	 */
+	void prepare(Grid<BlockType,allocator>& grid, const StencilInfo& stencil)
+	{
+		m_components = stencil.selcomponents;
+		
+		const int ss[3] = {stencil.sx, stencil.sy, stencil.sz};
+		const int se[3] = {stencil.ex, stencil.ey, stencil.ez};
+		_prepare(grid, ss, se, stencil.tensorial);
+	}
+	
 	/**
 	 * Prepare the extended block.
 	 * @param collection    Collection of blocks in the grid (e.g. result of Grid::getBlockCollection()).
@@ -106,6 +352,16 @@ public:
 	 */
 	
 	void prepare(Grid<BlockType,allocator>& grid, const int stencil_start[3], const int stencil_end[3], const bool istensorial)
+	{
+		//without a stencil there are no selected components: those of a previous prepare() are dropped
+		m_components.clear();
+		
+		_prepare(grid, stencil_start, stencil_end, istensorial);
+	}
+	
+protected:
+	
+	void _prepare(Grid<BlockType,allocator>& grid, const int stencil_start[3], const int stencil_end[3], const bool istensorial)
 	{
 		NX = grid.getBlocksPerDimension(0);
 		NY = grid.getBlocksPerDimension(1);
@@ -152,22 +408,30 @@ public:
 			
 		}
 		
+		m_layout = BlockLayoutTraits<BlockType>::layout(sizeof(ElementTypeBlock) / sizeof(Real));
+		
+		//the components of narrower lab elements have to be given by a stencil
+		assert(sizeof(ElementType) == sizeof(ElementTypeBlock) || m_components.size() * sizeof(Real) == sizeof(ElementType));
+		
+		_make_plans();
+		
 		m_state = eMRAGBlockLab_Prepared;
 		//	printf("ss: %d %d %d  se: %d %d %d\n", m_stencilStart[0], m_stencilStart[1], m_stencilStart[2], 
 		//			m_stencilEnd[0], m_stencilEnd[1], m_stencilEnd[2]);
 	}
 	
+public:
+	
 	/**
 	 * Load a block (incl. ghosts for it).
 	 * This is not called internally but by the BlockProcessing-class. Hence a new version of BlockLab,
 	 * can just overwrite it and through template-passing to BlockProcessing, the right version will be
 	 * called.
 	 * @param info  Reference to info of block to be loaded.
+	 * @param lowerzghosts  If false, the ghosts below the block in z are not loaded (streaming along z).
 	 */
-	void load(const BlockInfo& info, const Real t=0, const bool applybc=true)
+	void load(const BlockInfo& info, const Real t=0, const bool applybc=true, const bool lowerzghosts=true)
 	{
-		const Grid<BlockType,allocator>& grid = *m_refGrid;
-		
 		//0. couple of checks
 		//1. load the block into the cache
 		//2. put the ghosts into the cache
@@ -176,88 +440,67 @@ public:
 		assert(m_state == eMRAGBlockLab_Prepared || m_state==eMRAGBlockLab_Loaded);
 		assert(m_cacheBlock != NULL);
 		
+		//1.
+		_load_block(*(BlockType *)info.ptrBlock, CopyTag());
+		
+		//2.
+		_load_ghosts(info, lowerzghosts);
+		
+		if (applybc) _apply_bc(info, t);
+		
+		m_lastIndex[0] = info.index[0];
+		m_lastIndex[1] = info.index[1];
+		m_lastIndex[2] = info.index[2];
+		
+		m_state = eMRAGBlockLab_Loaded;
+	}
+	
+	/**
+	 * Same as load(), for the +x neighbor of the block loaded last (otherwise it is load()).
+	 * The two labs share a slab, the last x-ghosts of one being the first points of the other
+	 * and vice versa: it is shifted within the lab, the rest is copied from the blocks.
+	 * The data of the two blocks must not have changed since the last load,
+	 * the points of the slab are those inside the block in y and z (the ghosts there are loaded again).
+	 */
+	void load_xnext(const BlockInfo& info, const Real t=0, const bool applybc=true)
+	{
 		const int nX = BlockType::sizeX;
 		const int nY = BlockType::sizeY;
 		const int nZ = BlockType::sizeZ;
 		
-		//1.
+		//thickness of the slab
+		const int w = m_stencilEnd[0] - 1 - m_stencilStart[0];
+		
+		const bool xnext = m_state == eMRAGBlockLab_Loaded && w <= nX &&
+		info.index[0] == m_lastIndex[0] + 1 && info.index[1] == m_lastIndex[1] && info.index[2] == m_lastIndex[2];
+		
+		if (!xnext)
 		{
-			assert(sizeof(ElementType) == sizeof(typename BlockType::ElementType));
-			
-			BlockType& block = *(BlockType *)info.ptrBlock;
-			
-			ElementTypeBlock * ptrSource = &block(0);
-			
-			for(int iz=0; iz<nZ; iz++)
-				for(int iy=0; iy<nY; iy++)
-				{					
-					ElementType * ptrDestination = &m_cacheBlock->Access(0-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]);
-					
-					//for(int ix=0; ix<nX; ix++, ptrSource++, ptrDestination++)
-					//	*ptrDestination = (ElementType)*ptrSource;
-					memcpy(ptrDestination, ptrSource, sizeof(ElementType)*nX);
-					
-					ptrSource+= nX;
-				}
+			load(info, t, applybc);
+			return;
 		}
 		
-		//2.
-		{
-			const bool xperiodic = is_xperiodic();
-			const bool yperiodic = is_yperiodic();
-			const bool zperiodic = is_zperiodic();
-			
-			const bool xskin = info.index[0]==0 || info.index[0]==grid.getBlocksPerDimension(0)-1;
-			const bool yskin = info.index[1]==0 || info.index[1]==grid.getBlocksPerDimension(1)-1;
-			const bool zskin = info.index[2]==0 || info.index[2]==grid.getBlocksPerDimension(2)-1;
-			
-			const int xskip = info.index[0]==0 ? -1 : 1;
-			const int yskip = info.index[1]==0 ? -1 : 1;
-			const int zskip = info.index[2]==0 ? -1 : 1;
-			
-			for(int icode=0; icode<27; icode++)
+		//1. the slab: from x = nX + stencil start of the last block to x = stencil start of this one
+		for(int iz=0; iz<nZ; iz++)
+			for(int iy=0; iy<nY; iy++)
 			{
-				if (icode == 1*1 + 3*1 + 9*1) continue;
-				
-				const int code[3] = { icode%3-1, (icode/3)%3-1, (icode/9)%3-1};
+				ElementType * const row = &m_cacheBlock->Access(0, iy-m_stencilStart[1], iz-m_stencilStart[2]);
 				
-				if (!xperiodic && code[0] == xskip && xskin) continue;
-				if (!yperiodic && code[1] == yskip && yskin) continue;
-				if (!zperiodic && code[2] == zskip && zskin) continue;
-				
-				if (!istensorial && abs(code[0])+abs(code[1])+abs(code[2])>1) continue;
-				
-				const int s[3] = { 
-					code[0]<1? (code[0]<0 ? m_stencilStart[0]:0 ) : nX, 
-					code[1]<1? (code[1]<0 ? m_stencilStart[1]:0 ) : nY, 
-					code[2]<1? (code[2]<0 ? m_stencilStart[2]:0 ) : nZ };
-				
-				const int e[3] = {
-					code[0]<1? (code[0]<0 ? 0:nX ) : nX+m_stencilEnd[0]-1, 
-					code[1]<1? (code[1]<0 ? 0:nY ) : nY+m_stencilEnd[1]-1, 
-					code[2]<1? (code[2]<0 ? 0:nZ ) : nZ+m_stencilEnd[2]-1};
-				
-				if (!grid.avail(info.index[0] + code[0], info.index[1] + code[1], info.index[2] + code[2])) continue;
-				
-				BlockType& b = grid(info.index[0] + code[0], info.index[1] + code[1], info.index[2] + code[2]);
-				
-				for(int iz=s[2]; iz<e[2]; iz++)
-					for(int iy=s[1]; iy<e[1]; iy++)
-					{
-						/*	char * ptrDest = (char*)&m_cacheBlock->Access(0-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]);
-						 const char * ptrSrc = (const char*)&b(0 - code[0]*BlockType::sizeX, iy - code[1]*BlockType::sizeY, iz - code[2]*BlockType::sizeZ);
-						 const int bytes = (e[0]-s[0])*sizeof(ElementType);
-						 memcpy(ptrDest, ptrSrc, bytes);*/
-						for(int ix=s[0]; ix<e[0]; ix++)
-							m_cacheBlock->Access(ix-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]) = 
-							(ElementType)b(ix - code[0]*BlockType::sizeX, iy - code[1]*BlockType::sizeY, iz - code[2]*BlockType::sizeZ);
-					}
+				std::copy(row + nX, row + nX + w, row);
 			}
-			
-			if (applybc) _apply_bc(info, t);			
-			
-			m_state = eMRAGBlockLab_Loaded;
-		}
+		
+		//2. the rest of the block and the other ghosts
+		_load_block(*(BlockType *)info.ptrBlock, CopyTag(), m_stencilEnd[0] - 1);
+		
+		_load_ghosts(info, true, false);
+		
+		if (applybc) _apply_bc(info, t);
+		
+		m_lastIndex[0] = info.index[0];
+		m_lastIndex[1] = info.index[1];
+		m_lastIndex[2] = info.index[2];
+		
+		m_state = eMRAGBlockLab_Loaded;
 	}
 	
 	/**
@@ -272,13 +515,9 @@ public:
 	{
 		assert(m_state == eMRAGBlockLab_Loaded);
 		
-		const int nX = m_cacheBlock->getSize()[0];
-		const int nY = m_cacheBlock->getSize()[1];
-		const int nZ = m_cacheBlock->getSize()[2];
-		
-		assert(ix-m_stencilStart[0]>=0 && ix-m_stencilStart[0]<nX);
-		assert(iy-m_stencilStart[1]>=0 && iy-m_stencilStart[1]<nY);
-		assert(iz-m_stencilStart[2]>=0 && iz-m_stencilStart[2]<nZ);
+		assert(ix-m_stencilStart[0]>=0 && ix-m_stencilStart[0]<(int)m_cacheBlock->getSize()[0]);
+		assert(iy-m_stencilStart[1]>=0 && iy-m_stencilStart[1]<(int)m_cacheBlock->getSize()[1]);
+		assert(iz-m_stencilStart[2]>=0 && iz-m_stencilStart[2]<(int)m_cacheBlock->getSize()[2]);
 		
 		return m_cacheBlock->Access(ix-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]);
 	}
@@ -288,13 +527,9 @@ public:
 	{
 		assert(m_state == eMRAGBlockLab_Loaded);
 		
-		const int nX = m_cacheBlock->getSize()[0];
-		const int nY = m_cacheBlock->getSize()[1];
-		const int nZ = m_cacheBlock->getSize()[2];
-		
-		assert(ix-m_stencilStart[0]>=0 && ix-m_stencilStart[0]<nX);
-		assert(iy-m_stencilStart[1]>=0 && iy-m_stencilStart[1]<nY);
-		assert(iz-m_stencilStart[2]>=0 && iz-m_stencilStart[2]<nZ);
+		assert(ix-m_stencilStart[0]>=0 && ix-m_stencilStart[0]<(int)m_cacheBlock->getSize()[0]);
+		assert(iy-m_stencilStart[1]>=0 && iy-m_stencilStart[1]<(int)m_cacheBlock->getSize()[1]);
+		assert(iz-m_stencilStart[2]>=0 && iz-m_stencilStart[2]<(int)m_cacheBlock->getSize()[2]);
 		
 		return m_cacheBlock->Access(ix-m_stencilStart[0], iy-m_stencilStart[1], iz-m_stencilStart[2]);
 	}
@@ -17,6 +17,9 @@ class BlockLabMPI : public MyBlockLab
 	const SynchronizerMPI * refSynchronizerMPI;
 	typedef typename MyBlockLab::BlockType BlockType;
 	
+	//narrower lab elements: the c-th selected component goes to the c-th Real of the element
+	std::vector<int> labcomponents;
+	
 protected:
 	int mypeindex[3], pesize[3], mybpd[3];
 	int gLastX, gLastY, gLastZ;
@@ -29,7 +32,12 @@ public:
 		refSynchronizerMPI->getpedata(mypeindex, pesize, mybpd);
 		StencilInfo stencil = refSynchronizerMPI->getstencil();
 		assert(stencil.isvalid());
-		MyBlockLab::prepare(grid, stencil.sx,  stencil.ex,  stencil.sy,  stencil.ey,  stencil.sz,  stencil.ez, stencil.tensorial);
+		MyBlockLab::prepare(grid, stencil);
+		
+		labcomponents.clear();
+		if (sizeof(typename MyBlockLab::ElementType) < sizeof(typename BlockType::ElementType))
+			for(int c=0; c<(int)stencil.selcomponents.size(); c++)
+				labcomponents.push_back(c);
 		gLastX = grid.getBlocksPerDimension(0)-1;
 		gLastY = grid.getBlocksPerDimension(1)-1;
 		gLastZ = grid.getBlocksPerDimension(2)-1;
@@ -77,7 +85,7 @@ public:
 									  this->m_stencilStart[0], this->m_stencilStart[1], this->m_stencilStart[2],
 									  this->m_cacheBlock->getSize()[0], this->m_cacheBlock->getSize()[1], this->m_cacheBlock->getSize()[2],
 									  sizeof(ET)/sizeof(Real),
-									  rsx, rex, rsy, rey, rsz, rez);
+									  rsx, rex, rsy, rey, rsz, rez, labcomponents.empty() ? NULL : &labcomponents.front());
 		}
 		
 		if (applybc) MyBlockLab::_apply_bc(info, t);
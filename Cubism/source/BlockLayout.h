@@ -0,0 +1,46 @@
+/*
+ *  BlockLayout.h
+ *  Cubism
+ *
+ */
+#pragma once
+
+/**
+ * Placement of the grid point components in the memory of a block, in floats.
+ * The points, ip = ix + sizeX*(iy + sizeY*iz), are grouped in tiles of "tile" points:
+ * component c of point ip sits at (ip/tile)*tilefloats + (ip%tile)*pointfloats + c*compfloats.
+ *   AoS:                   {1, gptfloats, 0, 1}
+ *   SoA:                   {npoints, 0, 1, npoints}
+ *   AoSoA, W points wide:  {W, W*ncomponents, 1, W}
+ */
+struct BlockLayout
+{
+	int tile, tilefloats, pointfloats, compfloats;
+
+	inline int offset(const int ip, const int c) const
+	{
+		return (ip / tile) * tilefloats + (ip % tile) * pointfloats + c * compfloats;
+	}
+
+	bool aos() const { return tile == 1 && compfloats == 1; }
+
+	static BlockLayout AoS(const int gptfloats)
+	{
+		const BlockLayout retval = {1, gptfloats, 0, 1};
+
+		return retval;
+	}
+};
+
+/**
+ * By default a block stores its points as an array of its ElementType.
+ * Blocks with another layout specialize this: BlockLab then reads them point by point
+ * through TBlock::operator(), and SynchronizerMPI packs them according to layout().
+ */
+template<typename TBlock>
+struct BlockLayoutTraits
+{
+	static const bool aos = true;
+
+	static BlockLayout layout(const int gptfloats) { return BlockLayout::AoS(gptfloats); }
+};
@@ -0,0 +1,127 @@
+/*
+ *  BlockSchedule.h
+ *  Cubism
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <cassert>
+
+#include <omp.h>
+
+#include "BlockInfo.h"
+#include "BlockAllocator.h"
+
+/**
+ * Dynamic schedule of a sweep over blocks that follows their NUMA placement (Grid::getNUMADomain()):
+ * a thread takes, one by one, the blocks of its domain (NUMAPartition::domain()), and once
+ * they are all taken it helps the other domains, in the order d+1, d+2, ...
+ * The blocks of a domain are then computed by the threads of that domain, whatever the sweep
+ * (RHS, update, SOS, dumps), as long as the threads are not idle.
+ * Constructed before the parallel region and shared by its threads:
+ *
+ *     BlockSchedule schedule(vInfo, grid);
+ *
+ *     #pragma omp parallel
+ *     {
+ *         NUMAPartition::bind();
+ *
+ *         for(int i=schedule.next(); i>=0; i=schedule.next())
+ *             ... vInfo[i] ...
+ *     }
+ *
+ * Unlike omp for, next() has no barrier at the end of the sweep.
+ */
+class BlockSchedule
+{
+	//the items of domain d: order[start[d]..start[d+1]-1]
+	std::vector<int> order, start;
+
+	//next entry of order to be taken in each domain, one per cache line
+	struct Counter { int next; char padding[64 - sizeof(int)]; };
+	std::vector<Counter> counters;
+
+	void _build(const std::vector<int>& domains)
+	{
+		const int D = NUMAPartition::domains();
+
+		start.assign(D + 1, 0);
+		for(int i=0; i<(int)domains.size(); ++i)
+			++start[domains[i] + 1];
+
+		for(int d=0; d<D; ++d)
+			start[d + 1] += start[d];
+
+		//stable: the items of a domain keep their order
+		order.resize(domains.size());
+		std::vector<int> fill(start.begin(), start.end() - 1);
+		for(int i=0; i<(int)domains.size(); ++i)
+			order[fill[domains[i]]++] = i;
+
+		counters.resize(D);
+		reset();
+	}
+
+	static int _fetch_and_increment(int& counter)
+	{
+		int retval;
+#if _OPENMP >= 201107
+#pragma omp atomic capture
+		retval = counter++;
+#else
+#pragma omp critical(blockschedule)
+		retval = counter++;
+#endif
+		return retval;
+	}
+
+public:
+
+	//the blocks of vInfo, any subset of the blocks of grid
+	template<typename TGrid>
+	BlockSchedule(const std::vector<BlockInfo>& vInfo, const TGrid& grid)
+	{
+		std::vector<int> domains(vInfo.size());
+
+		for(int i=0; i<(int)vInfo.size(); ++i)
+			domains[i] = grid.getNUMADomain(vInfo[i]);
+
+		_build(domains);
+	}
+
+	//items that are not single blocks (e.g. columns of blocks), domains[i] is the domain of item i
+	BlockSchedule(const std::vector<int>& domains)
+	{
+		_build(domains);
+	}
+
+	//to run the sweep again, outside of the parallel region
+	void reset()
+	{
+		for(int d=0; d<(int)counters.size(); ++d)
+			counters[d].next = start[d];
+	}
+
+	//the next item for the calling thread, -1 if all are taken
+	int next()
+	{
+		const int D = counters.size();
+		const int mydomain = NUMAPartition::domain(omp_get_thread_num());
+
+		for(int k=0; k<D; ++k)
+		{
+			const int d = (mydomain + k) % D;
+
+			if (counters[d].next >= start[d + 1]) continue;
+
+			const int entry = _fetch_and_increment(counters[d].next);
+
+			if (entry < start[d + 1]) return order[entry];
+		}
+
+		return -1;
+	}
+
+	int size() const { return order.size(); }
+};
@@ -12,12 +12,27 @@
 #include <iostream>
 #include <fstream>
 #include <cassert>
+#include <algorithm>
 
 #ifdef _USE_NUMA_
 #include <numa.h>
 #include <omp.h>
 #endif
 #include "BlockInfo.h"
+#include "BlockAllocator.h"
+
+//a new number at each allocation of the blocks of a grid, of any type
+inline unsigned long _grid_serial()
+{
+	static unsigned long counter = 0;
+	
+	unsigned long retval;
+	
+#pragma omp critical (gridserial)
+	retval = ++counter;
+	
+	return retval;
+}
 
 //hello git
 template <typename Block, template<typename X> class allocator=std::allocator>
@@ -25,6 +40,13 @@ class Grid
 {
 	Block * m_blocks;
 	
+	//see getSerial()
+	unsigned long m_serial;
+	
+	//built with the blocks, see getBlocksInfo() and getNUMAPartition()
+	std::vector<BlockInfo> m_infos;
+	std::vector<int> m_partition;
+	
 protected:
 	
 	const double maxextent;
@@ -43,18 +65,65 @@ protected:
 		m_blocks = alloc.allocate(N);
 		assert(m_blocks!=NULL);
 		
-		//numa touch
+		m_serial = _grid_serial();
+		
+		m_partition.resize(NUMAPartition::domains() + 1);
+		for(int d=0; d<=NUMAPartition::domains(); ++d)
+			m_partition[d] = NUMAPartition::first(d, N);
+		
+		//numa touch: the threads of domain d clear the blocks of d
 		#pragma omp parallel
 		{
 #ifdef _USE_NUMA_
-			const int cores_per_node = numa_num_configured_cpus() / numa_num_configured_nodes();
-			const int mynode = omp_get_thread_num() / cores_per_node;
-			numa_run_on_node(mynode);
-#endif
+			const int tid = omp_get_thread_num();
+			const int mynode = NUMAPartition::domain(tid);
+			NUMAPartition::bind();
+			
+			int myfirst = 0, nmine = 0;
+			for(int t=0; t<omp_get_num_threads(); ++t)
+				if (NUMAPartition::domain(t) == mynode)
+				{
+					if (t < tid) ++myfirst;
+					++nmine;
+				}
+			
+			//blocks of domains without threads are cleared by thread 0
+			const int s = m_partition[mynode], n = m_partition[mynode + 1] - s;
+			
+			for(int i=s + n * myfirst / nmine; i<s + n * (myfirst + 1) / nmine; ++i)
+				m_blocks[i].clear();
+			
+#pragma omp master
+			for(int d=NUMAPartition::domain(omp_get_num_threads() - 1) + 1; d<NUMAPartition::domains(); ++d)
+				for(int i=m_partition[d]; i<m_partition[d + 1]; ++i)
+					m_blocks[i].clear();
+#else
 #pragma omp for schedule(static)
 			for(int i=0; i<(int)N; ++i)
 				m_blocks[i].clear();
+#endif
 		}	
+		
+		_make_infos();
+	}
+	
+	void _make_infos()
+	{
+		m_infos.clear();
+		m_infos.reserve(N);
+		
+		const double h = (maxextent / max(NX, max(NY, NZ)));
+		
+		for(unsigned int iz=0; iz<NZ; iz++)
+			for(unsigned int iy=0; iy<NY; iy++)
+				for(unsigned int ix=0; ix<NX; ix++)
+				{
+					const long long blockID = _encode(ix, iy, iz);
+					const int idx[3] = {ix, iy, iz};
+					const double origin[3] = {ix*h, iy*h, iz*h};
+					
+					m_infos.push_back(BlockInfo(blockID, idx, origin, h, h/Block::sizeX, _linaccess(blockID)));
+				}
 	}
 	
 	Block* _linaccess(const unsigned int idx) const
@@ -94,6 +163,10 @@ public:
 		std::cout << "done. " << std::endl;
 	}
 	
+	//identifies the grid and its blocks: it changes at setup(), a grid constructed at the address
+	//of a destroyed one gets another (see LabPool)
+	unsigned long getSerial() const { return m_serial; }
+	
 	virtual int getBlocksPerDimension(int idim) const
 	{
 		assert(idim>=0 && idim<3);
@@ -115,26 +188,34 @@ public:
 		return *_linaccess( _encode((ix+NX) % NX, (iy+NY) % NY, (iz+NZ) % NZ) );		
 	}
 	
-	virtual std::vector<BlockInfo> getBlocksInfo() const
+	/**
+	 * The infos of the blocks, in storage order. They are computed once: the reference is
+	 * valid, and the infos do not change, as long as the grid lives (and setup() is not called).
+	 * Copy them only to modify them.
+	 */
+	virtual const std::vector<BlockInfo>& getBlocksInfo() const
+	{
+		return m_infos;
+	}
+	
+	/**
+	 * The blocks [partition[d], partition[d+1]) of getBlocksInfo() are placed on NUMA domain d
+	 * (see NUMAPartition): the labs of domain d should be run by its threads.
+	 */
+	const std::vector<int>& getNUMAPartition() const
+	{
+		return m_partition;
+	}
+	
+	//the NUMA domain of a block of this grid (see BlockSchedule)
+	int getNUMADomain(const BlockInfo& info) const
 	{
-		std::vector<BlockInfo> r;
-		r.reserve(N);
+		const int idx = (Block *)info.ptrBlock - m_blocks;
 		
-		const double h = (maxextent / max(NX, max(NY, NZ)));
-
-		for(unsigned int iz=0; iz<NZ; iz++)
-			for(unsigned int iy=0; iy<NY; iy++)
-				for(unsigned int ix=0; ix<NX; ix++)
-				{
-					const long long blockID = _encode(ix, iy, iz);
-					const int idx[3] = {ix, iy, iz};
-					const double origin[3] = {ix*h, iy*h, iz*h};
-					
-					r.push_back(BlockInfo(blockID, idx, origin, h, h/Block::sizeX, _linaccess(blockID)));
-				}
+		assert(idx >= 0 && idx < (int)N);
 		
-		return r;
-	}	
+		return std::upper_bound(m_partition.begin(), m_partition.end(), idx) - m_partition.begin() - 1;
+	}
 };
 
 template <typename Block, template<typename X> class allocator>
@@ -0,0 +1,127 @@
+/*
+ *  GridCurve.h
+ *  Cubism
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+#include "Grid.h"
+#include "Indexers.h"
+
+/**
+ * Grid whose blocks are stored, and returned by getBlocksInfo(), in the order of a
+ * space-filling curve: TIndexer::encode(ix, iy, iz) of the enclosing MAXND^3 cube,
+ * MAXND being the largest number of blocks per dimension. Any NX, NY, NZ can be taken,
+ * the codes outside the grid are skipped.
+ * Contiguous chunks of blocks (OpenMP static schedule, first touch in Grid) are then
+ * compact regions of the domain: their labs read neighbors that are mostly in the chunk.
+ */
+template <typename TGrid, typename TIndexer>
+class GridCurve: public TGrid
+{
+protected:
+
+	//flat (ix + NX*(iy + NY*iz)) to curve index, and back
+	vector<int> f2c, c2f;
+
+	vector<BlockInfo> cached_infos;
+
+	void _generate_mapping()
+	{
+		const int N = this->N;
+		const int NX = this->NX;
+		const int NY = this->NY;
+		const int NZ = this->NZ;
+		const int MAXND = max(NX, max(NY, NZ));
+
+		TIndexer indexer(MAXND, MAXND, MAXND);
+
+		vector< pair< unsigned int, int > > tobesorted(N);
+
+		for(int iflat = 0; iflat < N; ++iflat)
+		{
+			const int ix = iflat % NX;
+			const int iy = (iflat / NX) % NY;
+			const int iz = (iflat / (NX * NY)) % NZ;
+
+			tobesorted[iflat] = make_pair(indexer.encode(ix, iy, iz), iflat);
+		}
+
+		std::sort(tobesorted.begin(), tobesorted.end());
+
+		c2f.resize(N);
+		for(int icurve = 0; icurve < N; ++icurve)
+			c2f[icurve] = tobesorted[icurve].second;
+
+		f2c.resize(N);
+		for(int icurve = 0; icurve < N; ++icurve)
+			f2c[tobesorted[icurve].second] = icurve;
+	}
+
+	vector<BlockInfo> _getBlocksInfo() const
+	{
+		const int N = this->N;
+		const unsigned int NX = this->NX;
+		const unsigned int NY = this->NY;
+		const unsigned int NZ = this->NZ;
+
+		std::vector<BlockInfo> r(N);
+
+		const double h = (this->maxextent / max(NX, max(NY, NZ)));
+
+		for(int icurve = 0; icurve < N; ++icurve)
+		{
+			const int iflat = c2f[icurve];
+
+			const int ix = iflat % NX;
+			const int iy = (iflat / NX) % NY;
+			const int iz = (iflat / (NX * NY)) % NZ;
+
+			const int idx[3] = {ix, iy, iz};
+			const double origin[3] = { ix * h, iy * h, iz * h };
+
+			r[icurve] = BlockInfo(icurve, idx, origin, h, h / TBlock::sizeX, this->_linaccess(icurve));
+		}
+
+		return r;
+	}
+
+public:
+
+	typedef typename TGrid::BlockType BlockType;
+
+	typedef typename TGrid::BlockType TBlock;
+
+	GridCurve(unsigned int nX, unsigned int nY=1, unsigned int nZ=1, const double maxextent = 1):
+		TGrid(nX, nY, nZ, maxextent)
+	{
+		_generate_mapping();
+
+		cached_infos = _getBlocksInfo();
+	}
+
+	//periodic as Grid::operator(), -1 wraps to N-1
+	TBlock& operator()(unsigned int ix, unsigned int iy = 0, unsigned int iz = 0) const
+	{
+		const unsigned int NX = this->NX;
+		const unsigned int NY = this->NY;
+		const unsigned int NZ = this->NZ;
+
+		const unsigned int iflat = (ix + NX) % NX + NX * ((iy + NY) % NY + NY * ((iz + NZ) % NZ));
+
+		assert(iflat < f2c.size());
+
+		return *(this->_linaccess(f2c[iflat]));
+	}
+
+	const vector<BlockInfo>& getBlocksInfo() const
+	{
+		return cached_infos;
+	}
+};
@@ -0,0 +1,21 @@
+/*
+ *  GridHilbert.h
+ *  Cubism
+ *
+ */
+#pragma once
+
+#include "GridCurve.h"
+
+//blocks in Hilbert-curve order: unlike the Z-curve, consecutive blocks are neighbors
+//(in a power-of-two cube), a chunk of blocks has no jumps across the domain
+template <typename TGrid>
+class GridHilbert: public GridCurve<TGrid, IndexerHilbert>
+{
+public:
+
+	GridHilbert(unsigned int nX, unsigned int nY=1, unsigned int nZ=1, const double maxextent = 1):
+		GridCurve<TGrid, IndexerHilbert>(nX, nY, nZ, maxextent)
+	{
+	}
+};
@@ -33,6 +33,7 @@ protected:
 	vector<BlockInfo> cached_blockinfo;
 	
 	map<StencilInfo, SynchronizerMPI *> SynchronizerMPIs;
+	bool neighborhood, sharedmemory;
 	
 	MPI::Cartcomm cartcomm;
 
@@ -40,7 +41,7 @@ public:
 	
 	GridMPI(const int npeX, const int npeY, const int npeZ,
 			const int nX, const int nY=1, const int nZ=1, 
-			const double maxextent = 1): TGrid(nX, nY, nZ, maxextent), timestamp(0) 
+			const double maxextent = 1): TGrid(nX, nY, nZ, maxextent), timestamp(0), neighborhood(false), sharedmemory(false) 
 	{
 		blocksize[0] = Block::sizeX;
 		blocksize[1] = Block::sizeY;
@@ -67,7 +68,7 @@ public:
 		
 		cartcomm.Get_coords(myrank, 3, mypeindex);
 		
-		vector<BlockInfo> vInfo = TGrid::getBlocksInfo();
+		const vector<BlockInfo>& vInfo = TGrid::getBlocksInfo();
         
 		for(int i=0; i<vInfo.size(); ++i)
 		{
@@ -97,12 +98,13 @@ public:
 		SynchronizerMPIs.clear();
 	}
 	
-	vector<BlockInfo> getBlocksInfo() const
+	//as Grid::getBlocksInfo(), with the global indices and origins
+	const vector<BlockInfo>& getBlocksInfo() const
 	{
 		return cached_blockinfo;
 	}
 	
-	vector<BlockInfo> getResidentBlocksInfo() const
+	const vector<BlockInfo>& getResidentBlocksInfo() const
 	{
 		return TGrid::getBlocksInfo();
 	}
@@ -122,9 +124,9 @@ public:
 		iy = (iy + nY) % nY;
 		iz = (iz + nZ) % nZ;
 		
-		const bool xinside = (ix>= originX && ix<nX);
-		const bool yinside = (iy>= originY && iy<nY);
-		const bool zinside = (iz>= originZ && iz<nZ);
+		const bool xinside = (ix>= originX && ix<originX+mybpd[0]);
+		const bool yinside = (iy>= originY && iy<originY+mybpd[1]);
+		const bool zinside = (iz>= originZ && iz<originZ+mybpd[2]);
 		
 		assert(TGrid::avail(ix-originX, iy-originY, iz-originZ));
 		return xinside && yinside && zinside;
@@ -164,13 +166,15 @@ public:
 		
 		if (itSynchronizerMPI == SynchronizerMPIs.end())
 		{
-			queryresult = new SynchronizerMPI(SynchronizerMPIs.size(), stencil, getBlocksInfo(), cartcomm, mybpd, blocksize);
+			queryresult = new SynchronizerMPI(SynchronizerMPIs.size(), stencil, getBlocksInfo(), cartcomm, mybpd, blocksize, sharedmemory);
+			
+			queryresult->setNeighborhoodCollectives(neighborhood);
 			
 			SynchronizerMPIs[stencil] = queryresult;
 		}
 		else  queryresult = itSynchronizerMPI->second;
 		
-		queryresult->sync(sizeof(typename Block::element_type)/sizeof(Real), sizeof(Real)>4 ? MPI_DOUBLE : MPI_FLOAT, timestamp);
+		queryresult->sync(BlockLayoutTraits<Block>::layout(sizeof(typename Block::element_type)/sizeof(Real)), sizeof(Real)>4 ? MPI_DOUBLE : MPI_FLOAT);
 		
 		timestamp++;
 		
@@ -203,6 +207,21 @@ public:
 			mypeindex[i] = this->mypeindex[i];
 	}
     
+	//halo exchange of the synchronizers, see SynchronizerMPI::setNeighborhoodCollectives()
+	void setNeighborhoodCollectives(const bool enabled)
+	{
+		neighborhood = enabled;
+		
+		for(map<StencilInfo, SynchronizerMPI*>::const_iterator it = SynchronizerMPIs.begin(); it != SynchronizerMPIs.end(); ++it)
+			it->second->setNeighborhoodCollectives(enabled);
+	}
+	
+	//node-local halo exchange through shared memory (MPI-3), for the synchronizers created from now on
+	void setSharedMemoryHalo(const bool enabled)
+	{
+		sharedmemory = enabled;
+	}
+	
     size_t getTimeStamp() const
     {
         return timestamp;
@@ -215,8 +234,6 @@ public:
     
     double getH() const
     {
-        vector<BlockInfo> vInfo = this->getBlocksInfo();
-        BlockInfo info = vInfo[0];
-        return info.h_gridpoint;
+        return cached_blockinfo[0].h_gridpoint;
     }
 };
@@ -27,6 +27,7 @@ typedef double Real;
 #endif
 
 #include "BlockInfo.h"
+#include "BlockSchedule.h"
 
 using namespace std;
 
@@ -81,33 +82,39 @@ void DumpHDF5(TGrid &grid, const int iCounter, const string f_name, const string
 	file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl_id);
 	status = H5Pclose(fapl_id);
 	
-#pragma omp parallel for
-	for(int i=0; i<(int)vInfo_local.size(); i++)
-	{       
-		BlockInfo& info = vInfo_local[i];
-		const unsigned int idx[3] = {info.index[0], info.index[1], info.index[2]};
-		B & b = *(B*)info.ptrBlock;
-		Streamer streamer(b);
+	BlockSchedule schedule(vInfo_local, grid);
+	
+#pragma omp parallel
+	{
+		NUMAPartition::bind();
+		
+		for(int i=schedule.next(); i>=0; i=schedule.next())
+		{       
+			BlockInfo& info = vInfo_local[i];
+			const unsigned int idx[3] = {info.index[0], info.index[1], info.index[2]};
+			B & b = *(B*)info.ptrBlock;
+			Streamer streamer(b);
 
-                for(unsigned int ix=sX; ix<eX; ix++)
-                  for(unsigned int iy=sY; iy<eY; iy++)
-                    for(unsigned int iz=sZ; iz<eZ; iz++)
-		      { 					
-					Real output[NCHANNELS];
-					for(unsigned int i=0; i<NCHANNELS; ++i)
-						output[i] = 0;
+	                for(unsigned int ix=sX; ix<eX; ix++)
+	                  for(unsigned int iy=sY; iy<eY; iy++)
+	                    for(unsigned int iz=sZ; iz<eZ; iz++)
+			      { 					
+						Real output[NCHANNELS];
+						for(unsigned int i=0; i<NCHANNELS; ++i)
+							output[i] = 0;
 					
-					streamer.operate(ix, iy, iz, (Real*)output);
+						streamer.operate(ix, iy, iz, (Real*)output);
 					
-					const unsigned int gx = idx[0]*B::sizeX + ix;
-					const unsigned int gy = idx[1]*B::sizeY + iy;
-					const unsigned int gz = idx[2]*B::sizeZ + iz;
+						const unsigned int gx = idx[0]*B::sizeX + ix;
+						const unsigned int gy = idx[1]*B::sizeY + iy;
+						const unsigned int gz = idx[2]*B::sizeZ + iz;
 					
-					Real * const ptr = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
+						Real * const ptr = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
                   
-					for(unsigned int i=0; i<NCHANNELS; ++i)
-						ptr[i] = output[i];
-				}
+						for(unsigned int i=0; i<NCHANNELS; ++i)
+							ptr[i] = output[i];
+					}
+		}
 	}
 	   
 	fapl_id = H5Pcreate(H5P_DATASET_XFER);
@@ -228,26 +235,32 @@ void ReadHDF5(TGrid &grid, const int iCounter, const string f_name, const string
 	mspace_id = H5Screate_simple(4, count, NULL);        
 	status = H5Dread(dataset_id, HDF_REAL, mspace_id, fspace_id, fapl_id, array_all);
 	
-#pragma omp parallel for
-	for(int i=0; i<vInfo_local.size(); i++)
+	BlockSchedule schedule(vInfo_local, grid);
+	
+#pragma omp parallel
 	{
-		BlockInfo& info = vInfo_local[i];
-		const int idx[3] = {info.index[0], info.index[1], info.index[2]};
-		B & b = *(B*)info.ptrBlock;
-		Streamer streamer(b);
+		NUMAPartition::bind();
+		
+		for(int i=schedule.next(); i>=0; i=schedule.next())
+		{
+			BlockInfo& info = vInfo_local[i];
+			const int idx[3] = {info.index[0], info.index[1], info.index[2]};
+			B & b = *(B*)info.ptrBlock;
+			Streamer streamer(b);
 		
-		for(int iz=sZ; iz<eZ; iz++)
-			for(int iy=sY; iy<eY; iy++)
-				for(int ix=sX; ix<eX; ix++)
-				{     
-					const int gx = idx[0]*B::sizeX + ix;
-					const int gy = idx[1]*B::sizeY + iy;
-					const int gz = idx[2]*B::sizeZ + iz;
+			for(int iz=sZ; iz<eZ; iz++)
+				for(int iy=sY; iy<eY; iy++)
+					for(int ix=sX; ix<eX; ix++)
+					{     
+						const int gx = idx[0]*B::sizeX + ix;
+						const int gy = idx[1]*B::sizeY + iy;
+						const int gz = idx[2]*B::sizeZ + iz;
 					
-					Real * const ptr_input = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
+						Real * const ptr_input = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
 					
-					streamer.operate(ptr_input, ix, iy, iz);
-				}
+						streamer.operate(ptr_input, ix, iy, iz);
+					}
+		}
 	}
 	
 	status = H5Pclose(fapl_id);
@@ -24,6 +24,7 @@
 using namespace std;
 
 #include "BlockInfo.h"
+#include "BlockSchedule.h"
 
 template<typename TGrid, typename Streamer>
 void DumpHDF5_MPI(TGrid &grid, const int iCounter, const string f_name, const string dump_path=".")
@@ -86,36 +87,42 @@ void DumpHDF5_MPI(TGrid &grid, const int iCounter, const string f_name, const st
 	file_id = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, fapl_id);
 	status = H5Pclose(fapl_id);
 	
-#pragma omp parallel for
-	for(unsigned int i=0; i<vInfo_local.size(); i++)
+	BlockSchedule schedule(vInfo_local, grid);
+	
+#pragma omp parallel
 	{
-		BlockInfo& info = vInfo_local[i];
-		const unsigned int idx[3] = {info.index[0], info.index[1], info.index[2]};
-		B & b = *(B*)info.ptrBlock;
-		Streamer streamer(b);
+		NUMAPartition::bind();
 		
-		for(unsigned int ix=sX; ix<eX; ix++)
+		for(int i=schedule.next(); i>=0; i=schedule.next())
 		{
-			const unsigned int gx = idx[0]*B::sizeX + ix;
-			for(unsigned int iy=sY; iy<eY; iy++)
+			BlockInfo& info = vInfo_local[i];
+			const unsigned int idx[3] = {info.index[0], info.index[1], info.index[2]};
+			B & b = *(B*)info.ptrBlock;
+			Streamer streamer(b);
+		
+			for(unsigned int ix=sX; ix<eX; ix++)
 			{
-				const unsigned int gy = idx[1]*B::sizeY + iy;
-				for(unsigned int iz=sZ; iz<eZ; iz++)
-				{   
-					const unsigned int gz = idx[2]*B::sizeZ + iz;
+				const unsigned int gx = idx[0]*B::sizeX + ix;
+				for(unsigned int iy=sY; iy<eY; iy++)
+				{
+					const unsigned int gy = idx[1]*B::sizeY + iy;
+					for(unsigned int iz=sZ; iz<eZ; iz++)
+					{   
+						const unsigned int gz = idx[2]*B::sizeZ + iz;
 					
-					assert(NCHANNELS*(gz + NZ * (gy + NY * gx)) < NX * NY * NZ * NCHANNELS);
+						assert(NCHANNELS*(gz + NZ * (gy + NY * gx)) < NX * NY * NZ * NCHANNELS);
 
-					Real * const ptr = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
+						Real * const ptr = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
 
-					Real output[NCHANNELS];
-					for(int i=0; i<NCHANNELS; ++i)
-						output[i] = 0;
+						Real output[NCHANNELS];
+						for(int i=0; i<NCHANNELS; ++i)
+							output[i] = 0;
 					
-					streamer.operate(ix, iy, iz, (Real*)output);
+						streamer.operate(ix, iy, iz, (Real*)output);
 					
-					for(int i=0; i<NCHANNELS; ++i)
-						ptr[i] = output[i];
+						for(int i=0; i<NCHANNELS; ++i)
+							ptr[i] = output[i];
+					}
 				}
 			}
 		}
@@ -245,26 +252,32 @@ void ReadHDF5_MPI(TGrid &grid, const string f_name, const string dump_path=".")
 	mspace_id = H5Screate_simple(4, count, NULL);        
 	status = H5Dread(dataset_id, HDF_REAL, mspace_id, fspace_id, fapl_id, array_all);
 	
-	#pragma omp parallel for
-	for(int i=0; i<vInfo_local.size(); i++)
+	BlockSchedule schedule(vInfo_local, grid);
+	
+#pragma omp parallel
 	{
-		BlockInfo& info = vInfo_local[i];
-		const int idx[3] = {info.index[0], info.index[1], info.index[2]};
-		B & b = *(B*)info.ptrBlock;
-		Streamer streamer(b);
+		NUMAPartition::bind();
 		
-                for(int ix=sX; ix<eX; ix++)
-		  for(int iy=sY; iy<eY; iy++)
-		    for(int iz=sZ; iz<eZ; iz++)
-		      {
-					const int gx = idx[0]*B::sizeX + ix;
-					const int gy = idx[1]*B::sizeY + iy;
-					const int gz = idx[2]*B::sizeZ + iz;
+		for(int i=schedule.next(); i>=0; i=schedule.next())
+		{
+			BlockInfo& info = vInfo_local[i];
+			const int idx[3] = {info.index[0], info.index[1], info.index[2]};
+			B & b = *(B*)info.ptrBlock;
+			Streamer streamer(b);
+		
+	                for(int ix=sX; ix<eX; ix++)
+			  for(int iy=sY; iy<eY; iy++)
+			    for(int iz=sZ; iz<eZ; iz++)
+			      {
+						const int gx = idx[0]*B::sizeX + ix;
+						const int gy = idx[1]*B::sizeY + iy;
+						const int gz = idx[2]*B::sizeZ + iz;
 					
-					Real * const ptr_input = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
+						Real * const ptr_input = array_all + NCHANNELS*(gz + NZ * (gy + NY * gx));
 					
-					streamer.operate(ptr_input, ix, iy, iz);
-				}
+						streamer.operate(ptr_input, ix, iy, iz);
+					}
+		}
 	}
 	
 	status = H5Pclose(fapl_id);
@@ -81,3 +81,101 @@ public:
         }
 	}
 };
+
+//3D Hilbert curve on the enclosing 2^depth cube (Skilling, "Programming the Hilbert curve", 2004):
+//consecutive codes are face neighbors. depth is capped at 10 as for IndexerMorton
+class IndexerHilbert : public Indexer
+{
+    unsigned int depth;
+public:
+	IndexerHilbert(const unsigned int sizeX, const unsigned int sizeY, const unsigned int sizeZ):
+    Indexer(sizeX, sizeY, sizeZ)
+	{
+        depth = (unsigned int) fmax(1., fmin(10., ceil(log2((double)fmax(sizeX,fmax(sizeY,sizeZ))))));
+	}
+	
+	unsigned int encode(unsigned int ix, unsigned int iy, unsigned int iz) const
+	{
+        unsigned int X[3] = {ix, iy, iz};
+        
+        const unsigned int M = 1 << (depth-1);
+        
+        //inverse undo
+        for(unsigned int Q=M; Q>1; Q>>=1)
+        {
+            const unsigned int P = Q-1;
+            
+            for(int i=0; i<3; ++i)
+                if (X[i] & Q)
+                    X[0] ^= P;
+                else
+                {
+                    const unsigned int t = (X[0]^X[i]) & P;
+                    X[0] ^= t;
+                    X[i] ^= t;
+                }
+        }
+        
+        //gray encode
+        for(int i=1; i<3; ++i)
+            X[i] ^= X[i-1];
+        
+        unsigned int t = 0;
+        for(unsigned int Q=M; Q>1; Q>>=1)
+            if (X[2] & Q)
+                t ^= Q-1;
+        
+        for(int i=0; i<3; ++i)
+            X[i] ^= t;
+        
+        //the transposed code, x holding the most significant bit of each triple
+        unsigned int idx = 0;
+        
+        for(int b=depth-1; b>=0; --b)
+        {
+            for(int i=0; i<3; ++i)
+                idx = (idx << 1) | ((X[i] >> b) & 1);
+        }
+        
+		return idx;
+	}
+	
+	void decode(unsigned int code, unsigned int& ix, unsigned int& iy, unsigned int& iz) const
+	{
+        unsigned int X[3] = {0, 0, 0};
+        
+        for(int b=depth-1; b>=0; --b)
+        {
+            for(int i=0; i<3; ++i)
+                X[i] |= ((code >> (3*b + 2 - i)) & 1) << b;
+        }
+        
+        const unsigned int N = 2 << (depth-1);
+        
+        //gray decode
+        unsigned int t = X[2] >> 1;
+        for(int i=2; i>0; --i)
+            X[i] ^= X[i-1];
+        X[0] ^= t;
+        
+        //undo excess work
+        for(unsigned int Q=2; Q!=N; Q<<=1)
+        {
+            const unsigned int P = Q-1;
+            
+            for(int i=2; i>=0; --i)
+                if (X[i] & Q)
+                    X[0] ^= P;
+                else
+                {
+                    t = (X[0]^X[i]) & P;
+                    X[0] ^= t;
+                    X[i] ^= t;
+                }
+        }
+        
+        ix = X[0];
+        iy = X[1];
+        iz = X[2];
+	}
+};
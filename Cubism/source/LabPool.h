@@ -0,0 +1,117 @@
+/*
+ *  LabPool.h
+ *  Cubism
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <cstdlib>
+
+#include <omp.h>
+
+#include "StencilInfo.h"
+
+/**
+ * The labs of the OpenMP threads, one per thread and per Lab type, shared by all the dispatchers.
+ * A lab is constructed by its thread when the thread asks for it the first time, its memory
+ * is then first touched by that thread (NUMA-local, as the blocks of Grid).
+ * It is prepared again only when it is asked for another grid or another stencil. A grid is
+ * told apart by its address and its serial (Grid::getSerial()): a new grid at the address of
+ * a destroyed one, or a grid set up again, is another grid.
+ * To be called inside the parallel region, by each thread:
+ *
+ *     Lab& mylab = LabPool<Lab>::get(grid, stencil);
+ */
+template<typename Lab>
+class LabPool
+{
+	struct Slot
+	{
+		Lab lab;
+
+		//what the lab is prepared for, grid == NULL: not yet prepared
+		const void * grid;
+		unsigned long serial;
+		StencilInfo stencil;
+
+		Slot(): lab(), grid(NULL), serial(0), stencil() { }
+	};
+
+	//indexed by omp_get_thread_num(), the labs are released at exit
+	struct Slots : std::vector<Slot *>
+	{
+		~Slots()
+		{
+			for(int i=0; i<(int)this->size(); i++)
+				delete (*this)[i];
+		}
+	};
+
+	static Slot& _slot()
+	{
+		static Slots slots;
+
+		const int tid = omp_get_thread_num();
+
+		Slot * retval = NULL;
+
+		//a lookup per thread and per pass, the vector may grow if omp_set_num_threads() did
+#pragma omp critical (labpool)
+		{
+			if (tid >= (int)slots.size())
+				slots.resize(tid + 1, NULL);
+
+			if (slots[tid] == NULL)
+				slots[tid] = new Slot;
+
+			retval = slots[tid];
+		}
+
+		return *retval;
+	}
+
+	static bool _same(const StencilInfo& a, const StencilInfo& b)
+	{
+		return !(a < b) && !(b < a);
+	}
+
+public:
+
+	//the lab of the calling thread, prepared for grid and stencil
+	template<typename TGrid>
+	static Lab& get(TGrid& grid, const StencilInfo& stencil)
+	{
+		Slot& s = _slot();
+
+		if (s.grid != &grid || s.serial != grid.getSerial() || !_same(s.stencil, stencil))
+		{
+			s.lab.prepare(grid, stencil);
+			s.grid = &grid;
+			s.serial = grid.getSerial();
+			s.stencil = stencil;
+		}
+
+		return s.lab;
+	}
+
+	//same as above for the labs that are prepared with a synchronizer (BlockLabMPI),
+	//a grid has one synchronizer per stencil
+	template<typename TGrid, typename TSynchronizer>
+	static Lab& get(TGrid& grid, const TSynchronizer& synch)
+	{
+		Slot& s = _slot();
+
+		const StencilInfo stencil = synch.getstencil();
+
+		if (s.grid != &grid || s.serial != grid.getSerial() || !_same(s.stencil, stencil))
+		{
+			s.lab.prepare(grid, synch);
+			s.grid = &grid;
+			s.serial = grid.getSerial();
+			s.stencil = stencil;
+		}
+
+		return s.lab;
+	}
+};
@@ -10,38 +10,70 @@
 #include <vector>
 #include <cassert>
 
+#include "BlockLayout.h"
+
 void pack(const Real * const srcbase, Real * const dst, 
-			   const unsigned int gptfloats,
+			   const BlockLayout& layout,
 			   int * selected_components, const int ncomponents,
 			   const int xstart, const int ystart, const int zstart,
 			   const int xend, const int yend, const int zend)
 {	
-	for(int idst=0, iz=zstart; iz<zend; ++iz)
-		for(int iy=ystart; iy<yend; ++iy)
-			for(int ix=xstart; ix<xend; ++ix)
-			{
-				const Real * src = srcbase + gptfloats*(ix + _BLOCKSIZEX_*(iy + _BLOCKSIZEY_*iz));
-				
-				for(int ic=0; ic<ncomponents; ic++, idst++)
-					dst[idst] = src[selected_components[ic]];
-			}
+	if (layout.aos())
+	{
+		const unsigned int gptfloats = layout.tilefloats;
+		
+		for(int idst=0, iz=zstart; iz<zend; ++iz)
+			for(int iy=ystart; iy<yend; ++iy)
+				for(int ix=xstart; ix<xend; ++ix)
+				{
+					const Real * src = srcbase + gptfloats*(ix + _BLOCKSIZEX_*(iy + _BLOCKSIZEY_*iz));
+					
+					for(int ic=0; ic<ncomponents; ic++, idst++)
+						dst[idst] = src[selected_components[ic]];
+				}
+	}
+	else
+		for(int idst=0, iz=zstart; iz<zend; ++iz)
+			for(int iy=ystart; iy<yend; ++iy)
+				for(int ix=xstart; ix<xend; ++ix)
+				{
+					const int ip = ix + _BLOCKSIZEX_*(iy + _BLOCKSIZEY_*iz);
+					
+					for(int ic=0; ic<ncomponents; ic++, idst++)
+						dst[idst] = srcbase[layout.offset(ip, selected_components[ic])];
+				}
 }
 
 void pack_stripes(const Real * const srcbase, Real * const dst, 
-					   const unsigned int gptfloats, 
+					   const BlockLayout& layout, 
 					   const int selstart, const int selend, 
 					   const int xstart, const int ystart, const int zstart,
 					   const int xend, const int yend, const int zend)
 {	
-	for(int idst=0, iz=zstart; iz<zend; ++iz)
-		for(int iy=ystart; iy<yend; ++iy)
-			for(int ix=xstart; ix<xend; ++ix)
-			{
-				const Real * src = srcbase + gptfloats*(ix + _BLOCKSIZEX_*(iy + _BLOCKSIZEY_*iz));
-				
-				for(int ic=selstart; ic<selend; ic++, idst++)
-					dst[idst] = src[ic];
-			}
+	if (layout.aos())
+	{
+		const unsigned int gptfloats = layout.tilefloats;
+		
+		for(int idst=0, iz=zstart; iz<zend; ++iz)
+			for(int iy=ystart; iy<yend; ++iy)
+				for(int ix=xstart; ix<xend; ++ix)
+				{
+					const Real * src = srcbase + gptfloats*(ix + _BLOCKSIZEX_*(iy + _BLOCKSIZEY_*iz));
+					
+					for(int ic=selstart; ic<selend; ic++, idst++)
+						dst[idst] = src[ic];
+				}
+	}
+	else
+		for(int idst=0, iz=zstart; iz<zend; ++iz)
+			for(int iy=ystart; iy<yend; ++iy)
+				for(int ix=xstart; ix<xend; ++ix)
+				{
+					const int ip = ix + _BLOCKSIZEX_*(iy + _BLOCKSIZEY_*iz);
+					
+					for(int ic=selstart; ic<selend; ic++, idst++)
+						dst[idst] = srcbase[layout.offset(ip, ic)];
+				}
 }
 
 void unpack(const Real * const pack, Real * const dstbase, 
@@ -27,7 +27,7 @@ public:
 		
 		output << inputGrid;
 		
-		const vector<BlockInfo> vInfo = inputGrid.getBlocksInfo();
+		const vector<BlockInfo>& vInfo = inputGrid.getBlocksInfo();
 		for(vector<BlockInfo>::const_iterator it = vInfo.begin(); it!= vInfo.end(); ++it)
 			((TBlock*)(it->ptrBlock))->template Write<Streamer>(output, streamer);
 	}
@@ -38,7 +38,7 @@ public:
 		
 		input >> inputGrid;
 		
-		const vector<BlockInfo> vInfo = inputGrid.getBlocksInfo();
+		const vector<BlockInfo>& vInfo = inputGrid.getBlocksInfo();
 		for(vector<BlockInfo>::const_iterator it = vInfo.begin(); it!= vInfo.end(); ++it)
 			((TBlock*)(it->ptrBlock))->template Read<Streamer>(input, streamer);
 	}
@@ -67,7 +67,7 @@ public:
 							{
 								Real output[NC];
 								
-								streamer.operate(block.data[iz][iy][ix], output);
+								streamer.operate(block(ix, iy, iz), output);
 								
 								const int gx = ix + ibx*BX;
 								const int gy = iy + iby*BY;
@@ -90,7 +90,7 @@ public:
 	template<typename TLab>
 	void WriteLabs(GridType & inputGrid, string fileName, const Real time=0, Streamer streamer = Streamer())
 	{
-		const vector<BlockInfo> vInfo = inputGrid.getBlocksInfo();
+		const vector<BlockInfo>& vInfo = inputGrid.getBlocksInfo();
 		
 		static const int BX = TBlock::sizeX;
 		static const int BY = TBlock::sizeY;
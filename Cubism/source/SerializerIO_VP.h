@@ -65,7 +65,7 @@ public:
 					for(int iy=0; iy<TBlock::sizeY; iy++)
 						for(int ix=0; ix<TBlock::sizeX; ix++)
 						{
-							streamer.operate(block.data[iz][iy][ix], out);
+							streamer.operate(block(ix, iy, iz), out);
 							
 							for(int channel=0; channel<nChannels; channel++)
 								matData->Access(channel, ix, iy, iz) = out[channel];
@@ -49,6 +49,16 @@ struct StencilInfo
 	{
 	}	
 	
+	StencilInfo& operator=(const StencilInfo& c)
+	{
+		sx = c.sx; sy = c.sy; sz = c.sz;
+		ex = c.ex; ey = c.ey; ez = c.ez;
+		selcomponents = c.selcomponents;
+		tensorial = c.tensorial;
+		
+		return *this;
+	}
+	
 	vector<int> _all() const 
 	{
 		int extra[] = {sx, sy, sz, ex, ey, ez, (int)tensorial};
@@ -15,6 +15,9 @@
 #include <algorithm>
 using namespace std;
 
+#include <omp.h>
+#include <sched.h>
+
 //#include <xmmintrin.h>
 
 #include "PUPkernelsMPI.h"
@@ -40,7 +43,7 @@ class SynchronizerMPI
 	struct PackInfo { Real * block, * pack; int sx, sy, sz, ex, ey, ez; };
 	struct SubpackInfo { Real * block, * pack; int sx, sy, sz, ex, ey, ez; int x0, y0, z0, xpacklenght, ypacklenght; };
 	
-	DependencyCubeMPI<MPI::Request> cube;
+	DependencyCubeMPI<int> cube;
 	const bool isroot;
 	const int synchID;
 	int send_thickness[3][2], recv_thickness[3][2];
@@ -66,9 +69,50 @@ class SynchronizerMPI
 	
 	struct CommData { 
 		Real * faces[3][2], * edges[3][2][2], * corners[2][2][2]; 
-		set<MPI::Request> pending;
 	} send, recv;
 	
+	//messages of the halo exchange with the other ranks. Receive i is the key i of the dependency cube,
+	//the sends are sorted by the channel of the receiver
+	enum { NCHANNELS = 26 }; //faces 0..5, edges 6..17, corners 18..25
+	struct Channel { Real * buffer; int count, rank, channel; };
+	vector<Channel> recvchannels, sendchannels;
+	
+	//requests of the exchange, set up at the first sync (the datatype is known there), npending receives are not yet arrived.
+	//point-to-point: persistent requests, the receives then the nsends sends.
+	//neighborhood collectives: one request for the whole exchange on graphcomm, arguments of MPI_Ineighbor_alltoallw in
+	//counts, displs and types (0: send, 1: receive)
+	bool neighborhood;
+	vector<MPI_Request> requests;
+	int nsends, npending;
+	MPI_Datatype requests_type;
+	MPI_Comm graphcomm;
+	vector<int> counts[2];
+	vector<MPI_Aint> displs[2];
+	vector<MPI_Datatype> types[2];
+	
+	//node-local channels (sharedmemory, MPI-3): the ranks of a node exchange through a shared window
+	//instead of messages. The segment of a rank holds a SharedHeader and its node-local receive buffers,
+	//the sender packs directly into them. At the sync of generation g the receiver sets posted[c] = g
+	//(buffer c is free), the sender waits for it, packs and sets ready[c] = g.
+	//Node-local receive j is the key recvchannels.size() + j of the dependency cube
+	struct SharedHeader { volatile int posted[NCHANNELS], ready[NCHANNELS]; MPI_Aint offset[NCHANNELS]; };
+	bool sharedmemory;
+	vector<Channel> sharedrecvchannels, sharedsendchannels;
+	vector<SharedHeader *> sharedsendheaders; //header of the receiver of sharedsendchannels[i]
+	vector<char> sharedarrived;
+	int generation, nsharedpending;
+	SharedHeader * sharedheader;
+	MPI_Comm nodecomm;
+	MPI_Win sharedwin;
+	
+	//packing of the sends, the messages to other nodes first, then the node-local ones, largest first
+	//within each group: message m is _sendchannel(packorder[m]), its entries
+	//are send_packinfos[packstart[m]..packstart[m+1]-1], packmessage[i] is the message of entry i,
+	//packleft[m] the entries of m not yet packed
+	vector<int> packorder, packstart, packmessage, packleft;
+	
+	enum Completion { TEST_SOME, WAIT_SOME, WAIT_ALL };
+	
 	bool _face_needed(const int d) const
 	{
 		return periodic[d] || mypeindex[d] > 0 && mypeindex[d] < pesize[d]-1;
@@ -638,15 +682,693 @@ class SynchronizerMPI
 	
 	void _myfree(Real *& ptr) {if (ptr!=NULL) { free(ptr); ptr=NULL;} }
 	
+	static Channel _channel(Real * buffer, const int count, const int rank, const int channel)
+	{
+		Channel retval = { buffer, count, rank, channel };
+		
+		return retval;
+	}
+	
+	static bool _bychannel(const Channel& a, const Channel& b) { return a.channel < b.channel; }
+	
+	template<typename T>
+	static T * _data(vector<T>& v) { return v.size() > 0 ? &v.front() : NULL; }
+	
+	void _setup_channels()
+	{
+		const int NC = stencil.selcomponents.size();
+		
+		//faces
+		for(int d=0; d<3; ++d)
+		{
+			if (!_face_needed(d)) continue;
+			
+			const int dim_other1 = (d+1)%3;
+			const int dim_other2 = (d+2)%3;
+			
+			for(int s=0; s<2; ++s)
+			{
+				const int NFACEBLOCK_SEND = NC * send_thickness[d][s] * blocksize[dim_other1] * blocksize[dim_other2];
+				const int NFACEBLOCK_RECV = NC * recv_thickness[d][s] * blocksize[dim_other1] * blocksize[dim_other2];
+				const int NFACE_SEND = NFACEBLOCK_SEND * mybpd[dim_other1] * mybpd[dim_other2];
+				const int NFACE_RECV = NFACEBLOCK_RECV * mybpd[dim_other1] * mybpd[dim_other2];
+				
+				int neighbor_index[3];
+				neighbor_index[d] = (mypeindex[d] + 2*s-1 + pesize[d])%pesize[d];
+				neighbor_index[dim_other1] = mypeindex[dim_other1];
+				neighbor_index[dim_other2] = mypeindex[dim_other2];
+				
+				if (_myself(neighbor_index)) continue;
+				
+				if (NFACE_RECV > 0)
+					recvchannels.push_back(_channel(recv.faces[d][s], NFACE_RECV, _rank(neighbor_index), 2*d + s));
+				
+				if (NFACE_SEND > 0)
+					sendchannels.push_back(_channel(send.faces[d][s], NFACE_SEND, _rank(neighbor_index), 2*d + 1-s));
+			}
+		}
+		
+		if (stencil.tensorial)
+		{
+			//edges
+			for(int d=0; d<3; ++d)
+			{
+				const int dim_other1 = (d+1)%3;
+				const int dim_other2 = (d+2)%3;
+				
+				for(int b=0; b<2; ++b)
+					for(int a=0; a<2; ++a)
+					{
+						const int NEDGEBLOCK_SEND = NC * blocksize[d] * send_thickness[dim_other2][b] * send_thickness[dim_other1][a];
+						const int NEDGEBLOCK_RECV = NC * blocksize[d] * recv_thickness[dim_other2][b] * recv_thickness[dim_other1][a];
+						const int NEDGE_SEND = NEDGEBLOCK_SEND * mybpd[d];
+						const int NEDGE_RECV = NEDGEBLOCK_RECV * mybpd[d];
+						
+						int neighbor_index[3];
+						neighbor_index[d] = mypeindex[d];
+						neighbor_index[dim_other1] = (mypeindex[dim_other1] + 2*a-1 + pesize[dim_other1])%pesize[dim_other1];
+						neighbor_index[dim_other2] = (mypeindex[dim_other2] + 2*b-1 + pesize[dim_other2])%pesize[dim_other2];
+						
+						if (_myself(neighbor_index)) continue;
+						
+						if (NEDGE_RECV > 0)
+							recvchannels.push_back(_channel(recv.edges[d][b][a], NEDGE_RECV, _rank(neighbor_index), 6 + 4*d + 2*b + a));
+						
+						if (NEDGE_SEND > 0)
+							sendchannels.push_back(_channel(send.edges[d][b][a], NEDGE_SEND, _rank(neighbor_index), 6 + 4*d + 2*(1-b) + (1-a)));
+					}
+			}
+			
+			//corners
+			for(int z=0; z<2; ++z)
+				for(int y=0; y<2; ++y)
+					for(int x=0; x<2; ++x)
+					{
+						const int NCORNERBLOCK_SEND = NC * send_thickness[0][x]*send_thickness[1][y]*send_thickness[2][z];
+						const int NCORNERBLOCK_RECV = NC * recv_thickness[0][x]*recv_thickness[1][y]*recv_thickness[2][z];
+						
+						int neighbor_index[3];
+						neighbor_index[0] = (mypeindex[0] + 2*x-1 + pesize[0])%pesize[0];
+						neighbor_index[1] = (mypeindex[1] + 2*y-1 + pesize[1])%pesize[1];
+						neighbor_index[2] = (mypeindex[2] + 2*z-1 + pesize[2])%pesize[2];
+						
+						if (_myself(neighbor_index)) continue;
+						
+						if (NCORNERBLOCK_RECV)
+							recvchannels.push_back(_channel(recv.corners[z][y][x], NCORNERBLOCK_RECV, _rank(neighbor_index), 18 + 4*z + 2*y + x));
+						
+						if (NCORNERBLOCK_SEND)
+							sendchannels.push_back(_channel(send.corners[z][y][x], NCORNERBLOCK_SEND, _rank(neighbor_index), 18 + 4*(1-z) + 2*(1-y) + (1-x)));
+					}
+		}
+		
+		sort(sendchannels.begin(), sendchannels.end(), _bychannel);
+	}
+	
+	//the message sends, then the node-local ones
+	const Channel& _sendchannel(const int k) const
+	{
+		return k < (int)sendchannels.size() ? sendchannels[k] : sharedsendchannels[k - sendchannels.size()];
+	}
+	
+	//moves the node-local channels of channels to shared, noderanks are their ranks in nodecomm
+	static void _split_shared(vector<Channel>& channels, vector<Channel>& shared, vector<int>& noderanks, MPI_Group cartgroup, MPI_Group nodegroup)
+	{
+		vector<Channel> remote;
+		
+		for(int i=0; i<(int)channels.size(); ++i)
+		{
+			int noderank = MPI_UNDEFINED;
+			MPI_Group_translate_ranks(cartgroup, 1, &channels[i].rank, nodegroup, &noderank);
+			
+			if (noderank == MPI_UNDEFINED)
+				remote.push_back(channels[i]);
+			else
+			{
+				shared.push_back(channels[i]);
+				noderanks.push_back(noderank);
+			}
+		}
+		
+		channels = remote;
+	}
+	
+	//the entries packed into or fetched from [from, from+count) now use [to, to+count)
+	void _remap(const Real * from, const int count, Real * to)
+	{
+		for(int i=0; i<(int)send_packinfos.size(); ++i)
+			if (send_packinfos[i].pack >= from && send_packinfos[i].pack < from + count)
+				send_packinfos[i].pack = to + (send_packinfos[i].pack - from);
+		
+		for(map<Real *, vector<PackInfo> >::iterator it = recv_packinfos.begin(); it != recv_packinfos.end(); ++it)
+			for(int i=0; i<(int)it->second.size(); ++i)
+				if (it->second[i].pack >= from && it->second[i].pack < from + count)
+					it->second[i].pack = to + (it->second[i].pack - from);
+		
+		for(map<Real *, vector<SubpackInfo> >::iterator it = recv_subpackinfos.begin(); it != recv_subpackinfos.end(); ++it)
+			for(int i=0; i<(int)it->second.size(); ++i)
+				if (it->second[i].pack >= from && it->second[i].pack < from + count)
+					it->second[i].pack = to + (it->second[i].pack - from);
+	}
+	
+	void _setup_shared()
+	{
+		generation = 0;
+		sharedheader = NULL;
+		nodecomm = MPI_COMM_NULL;
+		
+#if MPI_VERSION >= 3
+		if (!sharedmemory) return;
+		
+		MPI_Comm_split_type(cartcomm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodecomm);
+		
+		int nodesize = 1;
+		MPI_Comm_size(nodecomm, &nodesize);
+		
+		if (nodesize == 1)
+		{
+			MPI_Comm_free(&nodecomm);
+			return;
+		}
+		
+		vector<int> recvnoderanks, sendnoderanks;
+		{
+			MPI_Group cartgroup, nodegroup;
+			MPI_Comm_group(cartcomm, &cartgroup);
+			MPI_Comm_group(nodecomm, &nodegroup);
+			
+			_split_shared(recvchannels, sharedrecvchannels, recvnoderanks, cartgroup, nodegroup);
+			_split_shared(sendchannels, sharedsendchannels, sendnoderanks, cartgroup, nodegroup);
+			
+			MPI_Group_free(&cartgroup);
+			MPI_Group_free(&nodegroup);
+		}
+		
+		//my segment: the header, then the receive buffers, 64-byte aligned
+		size_t bytes = sizeof(SharedHeader) + 64;
+		for(int i=0; i<(int)sharedrecvchannels.size(); ++i)
+			bytes += sizeof(Real) * sharedrecvchannels[i].count + 64;
+		
+		MPI_Info info;
+		MPI_Info_create(&info);
+		MPI_Info_set(info, (char *)"alloc_shared_noncontig", (char *)"true");
+		
+		char * base = NULL;
+		MPI_Win_allocate_shared(bytes, 1, info, nodecomm, &base, &sharedwin);
+		MPI_Info_free(&info);
+		
+		MPI_Win_lock_all(MPI_MODE_NOCHECK, sharedwin);
+		
+		sharedheader = (SharedHeader *)base;
+		
+		for(int c=0; c<NCHANNELS; ++c)
+		{
+			sharedheader->posted[c] = 0;
+			sharedheader->ready[c] = 0;
+			sharedheader->offset[c] = 0;
+		}
+		
+		//the alignment within the page is the same for every rank that maps the segment
+		char * buffer = base + sizeof(SharedHeader);
+		for(int i=0; i<(int)sharedrecvchannels.size(); ++i)
+		{
+			Channel& c = sharedrecvchannels[i];
+			
+			buffer = (char *)(((size_t)buffer + 63) / 64 * 64);
+			sharedheader->offset[c.channel] = buffer - base;
+			
+			_remap(c.buffer, c.count, (Real *)buffer);
+			c.buffer = (Real *)buffer;
+			
+			buffer += sizeof(Real) * c.count;
+		}
+		
+		MPI_Win_sync(sharedwin);
+		MPI_Barrier(nodecomm);
+		MPI_Win_sync(sharedwin);
+		
+		for(int i=0; i<(int)sharedsendchannels.size(); ++i)
+		{
+			Channel& c = sharedsendchannels[i];
+			
+			MPI_Aint size;
+			int unit;
+			char * neighborbase = NULL;
+			MPI_Win_shared_query(sharedwin, sendnoderanks[i], &size, &unit, &neighborbase);
+			
+			SharedHeader * const header = (SharedHeader *)neighborbase;
+			Real * const target = (Real *)(neighborbase + header->offset[c.channel]);
+			
+			_remap(c.buffer, c.count, target);
+			c.buffer = target;
+			
+			sharedsendheaders.push_back(header);
+		}
+		
+		sharedarrived.resize(sharedrecvchannels.size());
+#endif
+	}
+	
+	void _free_shared()
+	{
+#if MPI_VERSION >= 3
+		if (sharedheader == NULL) return;
+		
+		MPI_Win_unlock_all(sharedwin);
+		MPI_Win_free(&sharedwin);
+		MPI_Comm_free(&nodecomm);
+		
+		sharedheader = NULL;
+#endif
+	}
+	
+	//orders the accesses to the shared window
+	void _memory_barrier()
+	{
+#if MPI_VERSION >= 3
+		if (sharedheader != NULL) MPI_Win_sync(sharedwin);
+#endif
+	}
+	
+	void _setup_packing()
+	{
+		const int S = sendchannels.size();
+		const int M = S + sharedsendchannels.size();
+		
+		vector<pair<int, int> > bysize;
+		for(int k=0; k<M; ++k)
+			bysize.push_back(make_pair(-_sendchannel(k).count, k));
+		
+		sort(bysize.begin(), bysize.begin() + S);
+		sort(bysize.begin() + S, bysize.end());
+		
+		vector< vector<PackInfo> > entries(M);
+		
+		for(int i=0; i<(int)send_packinfos.size(); ++i)
+		{
+			int m = 0;
+			
+			while(m < M && !(send_packinfos[i].pack >= _sendchannel(bysize[m].second).buffer && 
+							 send_packinfos[i].pack < _sendchannel(bysize[m].second).buffer + _sendchannel(bysize[m].second).count)) ++m;
+			
+			assert(m < M);
+			
+			entries[m].push_back(send_packinfos[i]);
+		}
+		
+		send_packinfos.clear();
+		packorder.resize(M);
+		packstart.resize(M + 1);
+		packmessage.clear();
+		packleft.resize(M);
+		
+		for(int m=0; m<M; ++m)
+		{
+			packorder[m] = bysize[m].second;
+			packstart[m] = send_packinfos.size();
+			
+			send_packinfos.insert(send_packinfos.end(), entries[m].begin(), entries[m].end());
+			packmessage.insert(packmessage.end(), entries[m].size(), m);
+		}
+		
+		packstart[M] = send_packinfos.size();
+	}
+	
+	void _setup_requests(MPI_Datatype MPIREAL)
+	{
+		_free_requests();
+		
+		requests_type = MPIREAL;
+		
+		if (neighborhood)
+		{
+#if MPI_VERSION >= 3
+			//a pair of ranks with several channels is a multigraph: the k-th send of a rank to the other one
+			//is the k-th receive of the other one from it, hence the order of the channels.
+			//Collective over cartcomm, also for the ranks without messages (node-local channels only)
+			vector<int> ranks[2];
+			
+			for(int k=0; k<2; ++k)
+			{
+				const vector<Channel>& channels = k == 0 ? sendchannels : recvchannels;
+				
+				for(int i=0; i<(int)channels.size(); ++i)
+				{
+					MPI_Aint address;
+					MPI_Get_address(channels[i].buffer, &address);
+					
+					ranks[k].push_back(channels[i].rank);
+					counts[k].push_back(channels[i].count);
+					displs[k].push_back(address);
+					types[k].push_back(MPIREAL);
+				}
+			}
+			
+			MPI_Dist_graph_create_adjacent(cartcomm, ranks[1].size(), _data(ranks[1]), MPI_UNWEIGHTED, 
+										   ranks[0].size(), _data(ranks[0]), MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &graphcomm);
+			
+			requests.push_back(MPI_REQUEST_NULL);
+			nsends = 0;
+#endif
+		}
+		else if (recvchannels.size() > 0 || sendchannels.size() > 0)
+		{
+			const int tagbase = NCHANNELS * synchID;
+			
+			requests.resize(recvchannels.size() + sendchannels.size(), MPI_REQUEST_NULL);
+			
+			for(int i=0; i<(int)recvchannels.size(); ++i)
+			{
+				const Channel c = recvchannels[i];
+				MPI_Recv_init(c.buffer, c.count, MPIREAL, c.rank, tagbase + c.channel, cartcomm, &requests[i]);
+			}
+			
+			for(int i=0; i<(int)sendchannels.size(); ++i)
+			{
+				const Channel c = sendchannels[i];
+				MPI_Send_init(c.buffer, c.count, MPIREAL, c.rank, tagbase + c.channel, cartcomm, &requests[recvchannels.size() + i]);
+			}
+			
+			nsends = sendchannels.size();
+		}
+	}
+	
+	//point-to-point: the receives, before the packing. Node-local: the receive buffers are free
+	void _start_receives()
+	{
+		if (!neighborhood && recvchannels.size() > 0)
+			MPI_Startall(recvchannels.size(), &requests.front());
+		
+		_memory_barrier();
+		
+		for(int i=0; i<(int)sharedrecvchannels.size(); ++i)
+			sharedheader->posted[sharedrecvchannels[i].channel] = generation;
+		
+		_memory_barrier();
+	}
+	
+	//node-local: waits until the receivers are done with the data of the last sync
+	void _wait_posted()
+	{
+		for(int i=0; i<(int)sharedsendchannels.size(); ++i)
+			while(sharedsendheaders[i]->posted[sharedsendchannels[i].channel] != generation)
+				sched_yield();
+		
+		_memory_barrier();
+	}
+	
+	//neighborhood collectives: the whole exchange, after the packing
+	void _start_exchange()
+	{
+#if MPI_VERSION >= 3
+		if (neighborhood && requests.size() > 0)
+			MPI_Ineighbor_alltoallw(MPI_BOTTOM, _data(counts[0]), _data(displs[0]), _data(types[0]), 
+									MPI_BOTTOM, _data(counts[1]), _data(displs[1]), _data(types[1]), graphcomm, &requests.front());
+#endif
+	}
+	
+	static int _atomic_read(int& counter)
+	{
+		int retval;
+#if _OPENMP >= 201107
+#pragma omp atomic read
+		retval = counter;
+#else
+#pragma omp flush
+		retval = counter;
+#endif
+		return retval;
+	}
+	
+	//starts the sends of the messages that are packed (point-to-point), marks the node-local ones as ready,
+	//returns their number
+	int _start_packed(vector<char>& started)
+	{
+		const int S = sendchannels.size();
+		
+		int retval = 0;
+		
+		for(int m=0; m<(int)packorder.size(); ++m)
+			if (!started[m] && _atomic_read(packleft[m]) == 0)
+			{
+#pragma omp flush
+				const int k = packorder[m];
+				
+				if (k >= S)
+				{
+					_memory_barrier();
+					sharedsendheaders[k - S]->ready[sharedsendchannels[k - S].channel] = generation;
+				}
+				else if (!neighborhood)
+					MPI_Start(&requests[recvchannels.size() + k]);
+				
+				started[m] = true;
+				++retval;
+			}
+		
+		return retval;
+	}
+	
+	//packs the send buffers in the order of packorder. Thread 0 starts the send of a message (point-to-point,
+	//node-local) as soon as its buffer is complete, while the other threads keep packing. The node-local
+	//messages are packed once their receivers are done with the last sync, the others meanwhile
+	void _pack_and_send(const BlockLayout& layout)
+	{
+		const int NC = stencil.selcomponents.size();
+		const int N = send_packinfos.size();
+		const int M = packorder.size();
+		const int NREMOTE = packstart[sendchannels.size()];
+		const bool pipelined = M > 0;
+		
+		vector<int> selcomponents = stencil.selcomponents;
+		sort(selcomponents.begin(), selcomponents.end());
+		
+		const bool contiguous = false;//selcomponents.back()+1-selcomponents.front() == selcomponents.size();
+		const int selstart = contiguous ? selcomponents.front() : 0;
+		const int selend = contiguous ? selcomponents.back()+1 : 0;
+		
+		for(int m=0; m<M; ++m)
+			packleft[m] = packstart[m + 1] - packstart[m];
+		
+		vector<char> started(M, false);
+		int nstarted = 0;
+		
+#pragma omp parallel
+		{
+			for(int pass=0; pass<2; ++pass)
+			{
+				if (pass == 1 && sharedsendchannels.size() > 0)
+				{
+#pragma omp master
+					_wait_posted();
+					
+#pragma omp barrier
+				}
+				
+				const int start = pass == 0 ? 0 : NREMOTE;
+				const int end = pass == 0 ? NREMOTE : N;
+				
+#pragma omp for schedule(dynamic) nowait
+				for(int i=start; i<end; ++i)
+				{
+					PackInfo info = send_packinfos[i];
+					
+					if (!contiguous)
+						pack(info.block, info.pack, layout, &selcomponents.front(), NC, info.sx, info.sy, info.sz, info.ex, info.ey, info.ez);
+					else
+						pack_stripes(info.block, info.pack, layout, selstart, selend, info.sx, info.sy, info.sz, info.ex, info.ey, info.ez);
+					
+					if (pipelined)
+					{
+#pragma omp flush
+#pragma omp atomic
+						packleft[packmessage[i]]--;
+						
+						if (omp_get_thread_num() == 0)
+							nstarted += _start_packed(started);
+					}
+				}
+			}
+			
+			if (omp_get_thread_num() == 0)
+				while(pipelined && nstarted < M)
+					nstarted += _start_packed(started);
+		}
+		
+		_start_exchange();
+	}
+	
+	//the sends of the last sync. Neighborhood collectives: the whole exchange, usually completed with the receives
+	void _wait_sends()
+	{
+		if (nsends > 0)
+			MPI_Waitall(nsends, &requests.front() + requests.size() - nsends, MPI_STATUSES_IGNORE);
+		
+		if (neighborhood && requests.size() > 0)
+			MPI_Wait(&requests.front(), MPI_STATUS_IGNORE);
+	}
+	
+	void _free_requests()
+	{
+		assert(npending == 0);
+		
+		_wait_sends();
+		
+		if (neighborhood)
+		{
+			if (requests.size() > 0)
+				MPI_Comm_free(&graphcomm);
+			
+			for(int k=0; k<2; ++k)
+			{
+				counts[k].clear();
+				displs[k].clear();
+				types[k].clear();
+			}
+		}
+		else
+			for(int i=0; i<(int)requests.size(); ++i)
+				MPI_Request_free(&requests[i]);
+		
+		requests.clear();
+		nsends = 0;
+		requests_type = MPI_DATATYPE_NULL;
+	}
+	
+	//messages: registers in the dependency cube the receives arrived so far, returns their number
+	int _complete_messages(const Completion completion)
+	{
+		if (npending == 0) return 0;
+		
+		const int NRECVS = recvchannels.size();
+		
+		if (neighborhood)
+		{
+			//one request: all or nothing
+			int flag = 1;
+			
+			if (completion == TEST_SOME)
+				MPI_Test(&requests.front(), &flag, MPI_STATUS_IGNORE);
+			else
+				MPI_Wait(&requests.front(), MPI_STATUS_IGNORE);
+			
+			if (!flag) return 0;
+			
+			for(int i=0; i<NRECVS; ++i)
+				cube.received(i);
+			
+			npending = 0;
+			
+			return NRECVS;
+		}
+		else if (completion == WAIT_ALL)
+		{
+			//the arrived receives are inactive, received() again is a no-op
+			MPI_Waitall(NRECVS, &requests.front(), MPI_STATUSES_IGNORE);
+			
+			for(int i=0; i<NRECVS; ++i)
+				cube.received(i);
+			
+			const int retval = npending;
+			npending = 0;
+			
+			return retval;
+		}
+		else
+		{
+			//inactive (arrived) receives are skipped, at least one is active
+			vector<int> indices(NRECVS);
+			int NSOLVED = 0;
+			
+			if (completion == TEST_SOME)
+				MPI_Testsome(NRECVS, &requests.front(), &NSOLVED, &indices.front(), MPI_STATUSES_IGNORE);
+			else
+			{
+				MPI_Waitsome(NRECVS, &requests.front(), &NSOLVED, &indices.front(), MPI_STATUSES_IGNORE);
+				assert(NSOLVED > 0);
+			}
+			
+			assert(NSOLVED != MPI_UNDEFINED);
+			
+			for(int i=0; i<NSOLVED; ++i)
+				cube.received(indices[i]);
+			
+			npending -= NSOLVED;
+			
+			return NSOLVED;
+		}
+	}
+	
+	//node-local: registers in the dependency cube the receives arrived so far, returns their number
+	int _complete_shared()
+	{
+		int retval = 0;
+		
+		for(int i=0; i<(int)sharedrecvchannels.size(); ++i)
+			if (!sharedarrived[i] && sharedheader->ready[sharedrecvchannels[i].channel] == generation)
+			{
+				cube.received(recvchannels.size() + i);
+				
+				sharedarrived[i] = true;
+				++retval;
+			}
+		
+		if (retval > 0) _memory_barrier();
+		
+		nsharedpending -= retval;
+		
+		return retval;
+	}
+	
+	//registers in the dependency cube the receives arrived so far, WAIT_SOME waits for at least one
+	void _complete(const Completion completion)
+	{
+		if (npending == 0 && nsharedpending == 0) return;
+		
+		const int arrived = _complete_shared();
+		
+		if (completion == WAIT_ALL)
+		{
+			_complete_messages(WAIT_ALL);
+			
+			while(nsharedpending > 0)
+			{
+				sched_yield();
+				_complete_shared();
+			}
+		}
+		else if (completion == TEST_SOME || arrived > 0)
+			_complete_messages(TEST_SOME);
+		else if (nsharedpending == 0)
+			_complete_messages(WAIT_SOME);
+		else
+			while(_complete_messages(TEST_SOME) == 0 && _complete_shared() == 0 && (npending > 0 || nsharedpending > 0))
+				sched_yield();
+	}
+	
+	
+	//registers receive i in the dependency cube, for the channel layout see NCHANNELS
+	void _expect(const int i)
+	{
+		const int c = i < (int)recvchannels.size() ? recvchannels[i].channel : sharedrecvchannels[i - recvchannels.size()].channel;
+		
+		if (c < 6)
+			cube.face(i, c/2, c%2);
+		else if (c < 18)
+			cube.edge(i, (c-6)/4, (c-6)%2, (c-6)/2%2);
+		else
+			cube.corner(i, (c-18)%2, (c-18)/2%2, (c-18)/4);
+	}
+	
 	//forbidden methods
-	SynchronizerMPI(const SynchronizerMPI& c):cube(-1,-1,-1), synchID(-1), isroot(true){ abort(); }
+	SynchronizerMPI(const SynchronizerMPI& c):cube(-1,-1,-1), isroot(true), synchID(-1){ abort(); }
 	
 	void operator=(const SynchronizerMPI& c){ abort(); }
 	
 public:
 	
-	SynchronizerMPI(const int synchID, StencilInfo stencil, vector<BlockInfo> globalinfos, MPI::Cartcomm cartcomm, const int mybpd[3], const int blocksize[3]): 
-	synchID(synchID), stencil(stencil), globalinfos(globalinfos), cube(mybpd[0], mybpd[1], mybpd[2]), isroot(MPI::COMM_WORLD.Get_rank() == 0), cartcomm(cartcomm)
+	SynchronizerMPI(const int synchID, StencilInfo stencil, const vector<BlockInfo>& globalinfos, MPI::Cartcomm cartcomm, const int mybpd[3], const int blocksize[3], const bool sharedmemory): 
+	cube(mybpd[0], mybpd[1], mybpd[2]), isroot(MPI::COMM_WORLD.Get_rank() == 0), synchID(synchID), stencil(stencil), globalinfos(globalinfos), cartcomm(cartcomm), sharedmemory(sharedmemory)
 	{			
 		cartcomm.Get_topo(3, pesize, periodic, mypeindex);
 		
@@ -664,7 +1386,7 @@ public:
 		for(int i=0; i<3; ++i) this->mybpd[i]=mybpd[i];
 		for(int i=0; i<3; ++i) this->blocksize[i]=blocksize[i];
 		
-		for(int i=0; i< globalinfos.size(); ++i)
+		for(int i=0; i< (int)globalinfos.size(); ++i)
 		{
 			I3 coord(globalinfos[i].index[0], globalinfos[i].index[1], globalinfos[i].index[2]);
 			c2i[coord] = i;
@@ -710,182 +1432,76 @@ public:
 				recv_packinfos[it->block].push_back(*it);
 		}
 		
-		assert(recv.pending.size() == 0);
-		assert(send.pending.size() == 0);
+		_setup_channels();
+		_setup_shared();
+		_setup_packing();
+		
+		neighborhood = false;
+		nsends = npending = nsharedpending = 0;
+		requests_type = MPI_DATATYPE_NULL;
+		graphcomm = MPI_COMM_NULL;
 	}
 	
 	~SynchronizerMPI()
 	{
-		for(int i=0;i<all_mallocs.size();++i)
+		_free_requests();
+		_free_shared();
+		
+		for(int i=0;i<(int)all_mallocs.size();++i)
 			_myfree(all_mallocs[i]);
 	}
 	
-	virtual void sync(unsigned int gptfloats, MPI::Datatype MPIREAL, const int timestamp)
+	//exchange of the next syncs: point-to-point messages (default) or MPI-3 neighborhood collectives,
+	//the blocks of the halo are then available once the whole exchange has completed
+	void setNeighborhoodCollectives(const bool enabled)
+	{
+#if MPI_VERSION < 3
+		if (enabled && isroot) printf("SynchronizerMPI: neighborhood collectives need MPI-3, keeping point-to-point messages\n");
+		
+		return;
+#endif
+		if (enabled == neighborhood) return;
+		
+		_free_requests();
+		
+		neighborhood = enabled;
+	}
+	
+	virtual void sync(const BlockLayout& layout, MPI::Datatype MPIREAL)
 	{
 		//0. wait for pending sends, couple of checks
-		//1. pack all stuff
-		//2. perform send/receive requests
+		//1. start the receives
+		//2. pack all stuff, send each message once packed
 		//3. setup the dependency
 		
 		//0.
-		{
-			const int NPENDINGSENDS = send.pending.size();
-			if (NPENDINGSENDS > 0)
-			{
-				vector<MPI::Request> pending(NPENDINGSENDS);
-				copy(send.pending.begin(), send.pending.end(), pending.begin());
-				MPI::Request::Waitall(NPENDINGSENDS, &pending.front());
-				
-				send.pending.clear();
-			}
-		}
+		if (requests_type != (MPI_Datatype)MPIREAL)
+			_setup_requests(MPIREAL);
+		else
+			_wait_sends();
+		
+		assert(npending == 0 && nsharedpending == 0);
+		
+		++generation;
+		
+		//1.
+		_start_receives();
 		
-		assert(recv.pending.size() == 0);
-		assert(send.pending.size() == 0);
+		//2.
+		_pack_and_send(layout);
 		
+		//3.
 		cube.prepare();
 		blockinfo_counter = globalinfos.size();
-		const int NC = stencil.selcomponents.size();
+		npending = recvchannels.size();
+		nsharedpending = sharedrecvchannels.size();
 		
-		//1. pack
-		{
-			const int N = send_packinfos.size();
-			
-			vector<int> selcomponents = stencil.selcomponents;
-			sort(selcomponents.begin(), selcomponents.end());
-			
-			const bool contiguous = false;//selcomponents.back()+1-selcomponents.front() == selcomponents.size();
-			
-			if (!contiguous)
-			{
-#pragma omp parallel for
-				for(int i=0; i<N; ++i)
-				{
-					PackInfo info = send_packinfos[i];
-					pack(info.block, info.pack, gptfloats, &selcomponents.front(), NC, info.sx, info.sy, info.sz, info.ex, info.ey, info.ez);
-				}
-			}
-			else 
-			{
-				const int selstart = selcomponents.front();
-				const int selend = selcomponents.back()+1;
-				
-#pragma omp parallel for
-				for(int i=0; i<N; ++i)
-				{
-					PackInfo info = send_packinfos[i];
-					pack_stripes(info.block, info.pack, gptfloats, selstart, selend, info.sx, info.sy, info.sz, info.ex, info.ey, info.ez);
-				}
-			}
-		}
+		if (nsharedpending > 0)
+			sharedarrived.assign(nsharedpending, false);
 		
-		//2. send requests
-		{
-			//faces
-			for(int d=0; d<3; ++d)
-			{
-				if (!_face_needed(d)) continue;
-				
-				const int dim_other1 = (d+1)%3;
-				const int dim_other2 = (d+2)%3;
-				
-				for(int s=0; s<2; ++s)
-				{
-					const int NFACEBLOCK_SEND = NC * send_thickness[d][s] * blocksize[dim_other1] * blocksize[dim_other2];
-					const int NFACEBLOCK_RECV = NC * recv_thickness[d][s] * blocksize[dim_other1] * blocksize[dim_other2];
-					const int NFACE_SEND = NFACEBLOCK_SEND * mybpd[dim_other1] * mybpd[dim_other2];
-					const int NFACE_RECV = NFACEBLOCK_RECV * mybpd[dim_other1] * mybpd[dim_other2];
-					
-					int neighbor_index[3];
-					neighbor_index[d] = (mypeindex[d] + 2*s-1 + pesize[d])%pesize[d];
-					neighbor_index[dim_other1] = mypeindex[dim_other1];
-					neighbor_index[dim_other2] = mypeindex[dim_other2];
-					
-					if (_myself(neighbor_index)) continue;
-					
-					if (NFACE_RECV > 0)
-					{
-						MPI::Request rc = cartcomm.Irecv(recv.faces[d][s], NFACE_RECV, MPIREAL, _rank(neighbor_index), 6*timestamp + 2*d + s);
-						recv.pending.insert(rc);
-						cube.face(rc, d, s);
-					}
-
-					if (NFACE_SEND > 0)
-					  send.pending.insert( cartcomm.Isend(send.faces[d][s], NFACE_SEND, MPIREAL, _rank(neighbor_index), 6*timestamp + 2*d + 1-s) );
-				}
-			}
-			
-			if (stencil.tensorial)
-			{
-				//edges
-				for(int d=0; d<3; ++d)
-				{
-					const int dim_other1 = (d+1)%3;
-					const int dim_other2 = (d+2)%3;
-										
-					for(int b=0; b<2; ++b)
-						for(int a=0; a<2; ++a)
-						{
-							const int NEDGEBLOCK_SEND = NC * blocksize[d] * send_thickness[dim_other2][b] * send_thickness[dim_other1][a];
-							const int NEDGEBLOCK_RECV = NC * blocksize[d] * recv_thickness[dim_other2][b] * recv_thickness[dim_other1][a];
-							const int NEDGE_SEND = NEDGEBLOCK_SEND * mybpd[d];
-							const int NEDGE_RECV = NEDGEBLOCK_RECV * mybpd[d];
-							
-							int neighbor_index[3];
-							neighbor_index[d] = mypeindex[d];
-							neighbor_index[dim_other1] = (mypeindex[dim_other1] + 2*a-1 + pesize[dim_other1])%pesize[dim_other1];
-							neighbor_index[dim_other2] = (mypeindex[dim_other2] + 2*b-1 + pesize[dim_other2])%pesize[dim_other2];
-							
-							if (_myself(neighbor_index)) continue;
-							
-							if (NEDGE_RECV > 0)
-							{
-								MPI::Request rc = cartcomm.Irecv(recv.edges[d][b][a], NEDGE_RECV, MPIREAL, _rank(neighbor_index), 12*timestamp + 4*d + 2*b + a);
-								
-								recv.pending.insert(rc);
-								
-								cube.edge(rc, d, a, b);
-							}
-
-                                                        if (NEDGE_SEND > 0)
-							  send.pending.insert( cartcomm.Isend(send.edges[d][b][a], NEDGE_SEND, MPIREAL, _rank(neighbor_index), 12*timestamp + 4*d + 2*(1-b) + (1-a)));
-						}
-				}
-				
-				//corners
-				{
-					for(int z=0; z<2; ++z)
-						for(int y=0; y<2; ++y)
-							for(int x=0; x<2; ++x)
-								{								
-									const int NCORNERBLOCK_SEND = NC * send_thickness[0][x]*send_thickness[1][y]*send_thickness[2][z];
-									const int NCORNERBLOCK_RECV = NC * recv_thickness[0][x]*recv_thickness[1][y]*recv_thickness[2][z];
-									
-									int neighbor_index[3];
-									neighbor_index[0] = (mypeindex[0] + 2*x-1 + pesize[0])%pesize[0];
-									neighbor_index[1] = (mypeindex[1] + 2*y-1 + pesize[1])%pesize[1];
-									neighbor_index[2] = (mypeindex[2] + 2*z-1 + pesize[2])%pesize[2];
-									
-									if (_myself(neighbor_index)) continue;
-									
-									if (NCORNERBLOCK_RECV)
-									{
-										MPI::Request rc = cartcomm.Irecv(recv.corners[z][y][x], NCORNERBLOCK_RECV, MPIREAL, _rank(neighbor_index), 8*timestamp + 4*z + 2*y + x);
-										
-										recv.pending.insert(rc);
-										
-										cube.corner(rc, x, y, z);
-									}
-
-									if (NCORNERBLOCK_SEND)
-									  send.pending.insert( cartcomm.Isend(send.corners[z][y][x], NCORNERBLOCK_SEND, MPIREAL, _rank(neighbor_index), 8*timestamp + 4*(1-z) + 2*(1-y) + (1-x)) \
-											       );
-								}
-				}
-			}
-		}
+		for(int i=0; i<npending + nsharedpending; ++i)
+			_expect(i);
 		
-		//3.
 		cube.make_dependencies(isroot);
 	}
 	
@@ -935,29 +1551,24 @@ public:
         
 		assert(cube.pendingcount() != 0 || blockinfo_counter == cube.pendingcount());
 		assert(blockinfo_counter != 0 || blockinfo_counter == cube.pendingcount());
-		assert(blockinfo_counter != 0 || recv.pending.size() == 0);
+		assert(blockinfo_counter != 0 || npending == 0 && nsharedpending == 0);
 		
 		return retval;
 	}
 	
+	//the blocks made available by the receives arrived since the last call, without waiting: empty if none
+	vector<BlockInfo> avail_ready()
+	{
+		_complete(TEST_SOME);
+		
+		return avail_inner();
+	}
+	
 	vector<BlockInfo> avail_halo()
 	{        
 		vector<BlockInfo> retval;
         	
-		const int NPENDING = recv.pending.size();
-		       
-		vector<MPI::Request> pending(NPENDING);
-		
-		copy(recv.pending.begin(), recv.pending.end(), pending.begin());
-		
-		vector<MPI::Request> old = pending;
-		
-		MPI::Request::Waitall(NPENDING, &pending.front());
-		for(int i=0; i<NPENDING; ++i)
-		{
-			cube.received(old[i]);
-			recv.pending.erase(old[i]);
-		}
+		_complete(WAIT_ALL);
 		
 		const int xorigin = mypeindex[0]*mybpd[0];
 		const int yorigin =	mypeindex[1]*mybpd[1];
@@ -1001,7 +1612,7 @@ public:
         
 		assert(cube.pendingcount() != 0 || blockinfo_counter == cube.pendingcount());
 		assert(blockinfo_counter != 0 || blockinfo_counter == cube.pendingcount());
-		assert(blockinfo_counter != 0 || recv.pending.size() == 0);
+		assert(blockinfo_counter != 0 || npending == 0 && nsharedpending == 0);
 		
 		return retval;
 	}
@@ -1010,44 +1621,10 @@ public:
 	{        
 		vector<BlockInfo> retval;
         	
-		const int NPENDING = recv.pending.size();
-		       
-		vector<MPI::Request> pending(NPENDING);
-		
-		copy(recv.pending.begin(), recv.pending.end(), pending.begin());
-		
-		vector<MPI::Request> old = pending;
-		
-		if(NPENDING > 0)
-		{
-			if(mybpd[0]==1 || mybpd[1]==1 || mybpd[2] == 1) //IS THERE SOMETHING MORE INTELLIGENT?!
-			{
-				MPI::Request::Waitall(NPENDING, &pending.front());
-				for(int i=0; i<NPENDING; ++i)
-				{
-					cube.received(old[i]);
-					recv.pending.erase(old[i]);
-				}
-			}
-			else
-			{
-				vector<int> indices(NPENDING);
-				size_t NSOLVED = 0;
-				if (blockinfo_counter == globalinfos.size())
-					NSOLVED = MPI::Request::Testsome(NPENDING, &pending.front(), &indices.front());
-				else
-				{
-					NSOLVED = MPI::Request::Waitsome(NPENDING, &pending.front(), &indices.front());
-					assert(NSOLVED > 0);
-				}
-				
-				for(int i=0; i<NSOLVED; ++i)
-				{
-					cube.received(old[indices[i]]);
-					recv.pending.erase(old[indices[i]]);
-				}
-			}
-		}
+		if(mybpd[0]==1 || mybpd[1]==1 || mybpd[2] == 1) //IS THERE SOMETHING MORE INTELLIGENT?!
+			_complete(WAIT_ALL);
+		else
+			_complete(blockinfo_counter == (int)globalinfos.size() ? TEST_SOME : WAIT_SOME);
 		
 		const int xorigin = mypeindex[0]*mybpd[0];
 		const int yorigin =	mypeindex[1]*mybpd[1];
@@ -1091,7 +1668,7 @@ public:
         
 		assert(cube.pendingcount() != 0 || blockinfo_counter == cube.pendingcount());
 		assert(blockinfo_counter != 0 || blockinfo_counter == cube.pendingcount());
-		assert(blockinfo_counter != 0 || recv.pending.size() == 0);
+		assert(blockinfo_counter != 0 || npending == 0 && nsharedpending == 0);
 		
 		return retval;
 	}
@@ -1100,7 +1677,7 @@ public:
 	{
 		vector<BlockInfo> accumulator;
 		
-		while(accumulator.size()<smallest && !done())
+		while((int)accumulator.size()<smallest && !done())
 		{
 			const vector<BlockInfo> r = avail();
 			
@@ -1112,7 +1689,7 @@ public:
 	
 	bool done() const
 	{
-		assert(!(blockinfo_counter == 0) || recv.pending.size() == 0);
+		assert(!(blockinfo_counter == 0) || npending == 0 && nsharedpending == 0);
 		
 		return blockinfo_counter == 0;
 	}
@@ -1152,9 +1729,13 @@ class MyRange
   }
 };
 
+	//labcomponents: where the selected components go in the elements of the lab, the same indices if NULL
 	void fetch(const Real * const ptrBlock, Real * const ptrLab, const int x0, const int y0, const int z0,
-		   const int xsize, const int ysize, const int zsize, const int gptfloats, const int rsx, const int rex, const int rsy, const int rey, const int rsz, const int rez) const 
+		   const int xsize, const int ysize, const int zsize, const int gptfloats, const int rsx, const int rex, const int rsy, const int rey, const int rsz, const int rez,
+		   const int * const labcomponents = NULL) const 
 	{
+	  const int * const dstcomponents = labcomponents != NULL ? labcomponents : &stencil.selcomponents.front();
+
 	  //build range
 	  MyRange myrange(rsx, rex, rsy, rey, rsz, rez);
 
@@ -1177,7 +1758,7 @@ class MyRange
 
 					const int nsrc = (itpack->ex-itpack->sx)*(itpack->ey-itpack->sy)*(itpack->ez-itpack->sz);
 					
-					unpack(itpack->pack, ptrLab, gptfloats, &stencil.selcomponents.front(), stencil.selcomponents.size(), nsrc,
+					unpack(itpack->pack, ptrLab, gptfloats, dstcomponents, stencil.selcomponents.size(), nsrc,
 						   itpack->sx-x0, itpack->sy-y0, itpack->sz-z0, 
 						   itpack->ex-x0, itpack->ey-y0, itpack->ez-z0, 
 						   xsize, ysize, zsize);
@@ -1204,7 +1785,7 @@ class MyRange
 
 				    if (myrange.outside(packrange)) continue;
 
-					unpack_subregion(itsubpack->pack, ptrLab, gptfloats, &stencil.selcomponents.front(), stencil.selcomponents.size(), 
+					unpack_subregion(itsubpack->pack, ptrLab, gptfloats, dstcomponents, stencil.selcomponents.size(), 
 									 itsubpack->x0, itsubpack->y0, itsubpack->z0,
 									 itsubpack->xpacklenght, itsubpack->ypacklenght,
 									 itsubpack->sx-x0, itsubpack->sy-y0, itsubpack->sz-z0, 
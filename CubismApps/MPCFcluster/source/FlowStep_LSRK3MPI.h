@@ -9,8 +9,12 @@
 #pragma once
 #include <limits>
 #include <omp.h>
+#include <sched.h>
+#include <unistd.h>
 
 #include <BlockLabMPI.h>
+#include <LabPool.h>
+#include <BlockSchedule.h>
 #include <Histogram.h>
 
 #include <FlowStep_LSRK3.h>
@@ -22,6 +26,11 @@
 #include <Update_QPX.h>
 #endif
 
+#ifdef _AVX_
+#include <Convection_AVX.h>
+#include <Update_AVX.h>
+#endif
+
 #ifdef _USE_HPM_
 #include <mpi.h>
 extern "C" void HPM_Start(char *);
@@ -112,75 +121,133 @@ namespace LSRK3MPIdata
 				cout << "======================================================" << endl;
 				
 				Kflow::printflops(LSRK3data::PEAKPERF_CORE*1e9, LSRK3data::PEAKBAND*1e9, LSRK3data::NCORES, 1,  NBLOCKS*NRANKS, global_t_fs/(double)LSRK3data::ReportFreq/NRANKS);
-				Kupdate::printflops(LSRK3data::PEAKPERF_CORE*1e9, LSRK3data::PEAKBAND*1e9, LSRK3data::NCORES, 1, NBLOCKS*NRANKS, global_t_up/(double)LSRK3data::ReportFreq/NRANKS);
+				
+				if (!LSRK3data::fused)
+					Kupdate::printflops(LSRK3data::PEAKPERF_CORE*1e9, LSRK3data::PEAKBAND*1e9, LSRK3data::NCORES, 1, NBLOCKS*NRANKS, global_t_up/(double)LSRK3data::ReportFreq/NRANKS);
 			}
 		}
 	}
 }
 
-template<typename Lab, typename Operator, typename TGrid>
-void _process(vector<BlockInfo>& vInfo, Operator rhs, TGrid& grid, const Real t, const bool record) 
+//fused != NULL: the update of the blocks is run during the sweep (see LSRK3data::FusedUpdate)
+template<typename Lab, typename Operator, typename TGrid, typename TFused>
+void _process(const vector<BlockInfo>& vInfo, Operator rhs, TGrid& grid, const Real t, const bool record, TFused * const fused) 
 {
-#if 1
-
+    BlockSchedule schedule(vInfo, grid);
+    
+    //FluidBlock::uniform is set by the caller (see LSRK3data::quiescent)
+    const bool bQuiescent = LSRK3data::quiescent && !fused;
+    
 #pragma omp parallel
     {
-        vector<BlockInfo>myInfo = vInfo;
-        BlockInfo * ary = &myInfo.front();
+        NUMAPartition::bind();
+        
+        const BlockInfo * const ary = &vInfo.front();
         
         Operator myrhs = rhs;
-        Lab mylab;
         
         const SynchronizerMPI& synch = grid.get_SynchronizerMPI(myrhs);
         
-        const int N = vInfo.size();
-        mylab.prepare(grid, synch);
+        Lab& mylab = LabPool<Lab>::get(grid, synch);
         
-#pragma omp for schedule(runtime)
-        for(int i=0; i<N; i++)
+        for(int i=schedule.next(); i>=0; i=schedule.next())
         {
+            if (bQuiescent && LSRK3data::skip(ary[i], grid, myrhs.a)) continue;
+            
             mylab.load(ary[i], t);
 			
             myrhs(mylab, ary[i], *(FluidBlock*)ary[i].ptrBlock);
+            
+            if (fused) fused->done(ary[i]);
         }		
     }
+}
 
-#else
-	static Lab * labs = NULL;
-
-	if (labs == NULL)
-	{
-		int NTH = omp_get_max_threads();
-		//printf("allocating %d labs\n", NTH); fflush(0);
-
-		const SynchronizerMPI& synch = grid.get_SynchronizerMPI(rhs);
-		labs = new Lab[NTH];
-
-		for(int i = 0; i < NTH; ++i)
-			labs[i].prepare(grid, synch);
-	}
-
+//-dispatcher event: one task per block. The master thread takes the inner blocks at once, then polls
+//the receives (SynchronizerMPI::avail_ready) and turns the blocks of each arrived message into tasks,
+//the other threads compute them. The halo of one slow neighbor holds back only its own blocks.
+//When no message has arrived, the master polls less and less often. It returns the time spent by
+//the master in the synchronizer, waiting included
+template<typename Lab, typename Operator, typename TGrid, typename TFused>
+double _process_events(SynchronizerMPI& synch, Operator rhs, TGrid& grid, const Real t, TFused * const fused)
+{
+    //FluidBlock::uniform is set by the caller (see LSRK3data::quiescent)
+    const bool bQuiescent = LSRK3data::quiescent && !fused;
+    
+    vector<Lab *> labs(omp_get_max_threads());
+    
+    double tsynch = 0;
+    
 #pragma omp parallel
     {
-		vector<BlockInfo>myInfo = vInfo;
-		BlockInfo * ary = &myInfo.front();
-		const int tid = omp_get_thread_num();
-	
-        Operator myrhs = rhs;
-       
-        const int N = vInfo.size();
-        Lab& mylab = labs[tid];
+        NUMAPartition::bind();
         
-#pragma omp for schedule(runtime)
-		for(int i=0; i<N; i++)
-		{
-			mylab.load(ary[i], t);
-			
-			myrhs(mylab, ary[i], *(FluidBlock*)ary[i].ptrBlock);
-		}	
-    }
-
+        labs[omp_get_thread_num()] = &LabPool<Lab>::get(grid, (const SynchronizerMPI&)synch);
+        
+#pragma omp barrier
+        
+#pragma omp master
+        {
+            Timer timer;
+            
+            timer.start();
+            vector<BlockInfo> avail = synch.avail_inner();
+            tsynch += timer.stop();
+            
+            //consecutive polls with no message
+            int nidle = 0;
+            
+            while(true)
+            {
+                for(int i=0; i<(int)avail.size(); ++i)
+                {
+                    const BlockInfo info = avail[i];
+                    
+#pragma omp task firstprivate(info)
+                    {
+                        Operator myrhs = rhs;
+                        
+                        if (!(bQuiescent && LSRK3data::skip(info, grid, myrhs.a)))
+                        {
+                            Lab& mylab = *labs[omp_get_thread_num()];
+                            
+                            mylab.load(info, t);
+                            
+                            myrhs(mylab, info, *(FluidBlock*)info.ptrBlock);
+                            
+                            if (fused) fused->done(info);
+                        }
+                    }
+                }
+                
+                if (synch.done()) break;
+                
+                timer.start();
+                avail = synch.avail_ready();
+                tsynch += timer.stop();
+                
+                if (avail.size() == 0)
+                {
+#if _OPENMP >= 201107
+#pragma omp taskyield
 #endif
+                    //give the core to the workers, then sleep up to 64 us before the next poll
+                    timer.start();
+                    if (nidle < 4)
+                        sched_yield();
+                    else
+                        usleep(1 << min(nidle - 4, 6));
+                    tsynch += timer.stop();
+                    
+                    nidle = min(nidle + 1, 10);
+                }
+                else
+                    nidle = 0;
+            }
+        }
+    }
+    
+    return tsynch;
 }
 
 template<typename TGrid>
@@ -206,15 +273,25 @@ class FlowStep_LSRK3MPI : public FlowStep_LSRK3
 	template<typename Kflow, typename Kupdate>
 	struct LSRKstepMPI
 	{
+		//max characteristic speed of the local blocks after the step
+		Real maxsos;
+		
 		LSRKstepMPI(TGrid& grid, Real dtinvh, const Real current_time)
 		{
-			vector<BlockInfo> vInfo = grid.getBlocksInfo();
+			const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
 			
             vector< pair<double, double> > timings;
             
-			timings.push_back(step(grid, vInfo, 0      , 1./4, dtinvh, current_time));
-			timings.push_back(step(grid, vInfo, -17./32, 8./9, dtinvh, current_time));
-			timings.push_back(step(grid, vInfo, -32./27, 3./4, dtinvh, current_time));
+			//the readers of the blocks do not change across the substeps
+			LSRK3data::FusedUpdate<Kupdate> * fused = NULL;
+			if (LSRK3data::fused)
+				fused = new LSRK3data::FusedUpdate<Kupdate>(vInfo, grid, false);
+            
+			timings.push_back(step(grid, vInfo, 0      , 1./4, dtinvh, current_time, fused));
+			timings.push_back(step(grid, vInfo, -17./32, 8./9, dtinvh, current_time, fused));
+			timings.push_back(step(grid, vInfo, -32./27, 3./4, dtinvh, current_time, fused, &maxsos));
+            
+			delete fused;
             
 			double avg1 = ( timings[0].first  + timings[1].first  + timings[2].first  )/3;
 			double avg2 = ( timings[0].second + timings[1].second + timings[2].second )/3;
@@ -222,14 +299,21 @@ class FlowStep_LSRK3MPI : public FlowStep_LSRK3
 			LSRK3MPIdata::notify<Kflow, Kupdate>(avg1, avg2, vInfo.size(), 3);
 		}		      	
 		
-		pair<double, double> step(TGrid& grid, vector<BlockInfo>& vInfo, Real a, Real b, Real dtinvh, const Real current_time)
+		//maxsos != NULL: the update also computes the max characteristic speed of the new state
+		pair<double, double> step(TGrid& grid, const vector<BlockInfo>& vInfo, Real a, Real b, Real dtinvh, const Real current_time, LSRK3data::FusedUpdate<Kupdate> * const fused, Real * const maxsos=NULL)
 		{
 			
 			Timer timer;	
             LSRK3data::FlowStep<Kflow, Lab> rhs(a, dtinvh);   
+			LSRK3data::Update<Kupdate> update(b, &vInfo.front());
+			
+			if (fused) fused->reset(update, maxsos != NULL);
 			
             timer.start();            
 			
+			//before the two passes of _process, that read the flags of the neighbors
+			if (LSRK3data::quiescent && !fused) LSRK3data::mark_uniform(vInfo, grid);
+			
 #ifdef _USE_HPM_
 			if (LSRK3data::step_id>0) HPM_Start("RHS sync method");
 #endif
@@ -244,7 +328,21 @@ class FlowStep_LSRK3MPI : public FlowStep_LSRK3
 			
 			const bool buse2pass = true;
 			
-			if(buse2pass)
+			if (LSRK3data::dispatcher == "event")
+			{
+				Timer timer2;
+				
+				timer2.start();
+				const double tsynch = _process_events< LabMPI >(synch, rhs, (TGrid&)grid, current_time, fused);
+				const double tevents = timer2.stop();
+				
+				LSRK3MPIdata::t_synch_fs += tsynch;
+				LSRK3MPIdata::t_bp_fs += tevents - tsynch;
+				
+				LSRK3MPIdata::counter++;
+				LSRK3MPIdata::nsynch++;
+			}
+			else if(buse2pass)
 				for (int ipass = 0; ipass < 2; ipass++)
 				{			
 					Timer timer2;
@@ -262,7 +360,7 @@ class FlowStep_LSRK3MPI : public FlowStep_LSRK3
 					const bool record = LSRK3data::step_id%10==0;
 					
 					timer2.start();
-					_process< LabMPI >(avail, rhs, (TGrid&)grid, current_time, record);
+					_process< LabMPI >(avail, rhs, (TGrid&)grid, current_time, record, fused);
 					LSRK3MPIdata::t_bp_fs += timer2.stop();
 					
 					LSRK3MPIdata::counter++;
@@ -280,7 +378,7 @@ class FlowStep_LSRK3MPI : public FlowStep_LSRK3
 					const bool record = LSRK3data::step_id%10==0;
 					
 					timer2.start();
-					_process< LabMPI >(avail, rhs, (TGrid&)grid, current_time, record);
+					_process< LabMPI >(avail, rhs, (TGrid&)grid, current_time, record, fused);
 					LSRK3MPIdata::t_bp_fs += timer2.stop();
 					
 					
@@ -296,9 +394,21 @@ class FlowStep_LSRK3MPI : public FlowStep_LSRK3
 #ifdef _USE_HPM_
 			if (LSRK3data::step_id>0)             HPM_Start("Update");
 #endif
-			LSRK3data::Update<Kupdate> update(b, &vInfo.front());
 			timer.start();
-			update.omp(vInfo.size());
+			if (fused)
+			{
+				assert(fused->complete());
+				
+				if (maxsos) *maxsos = fused->maxsos();
+			}
+			else
+			{
+				BlockSchedule schedule(vInfo, grid);
+				
+				const Real sos = update.omp(schedule, maxsos != NULL);
+				
+				if (maxsos) *maxsos = sos;
+			}
 #ifdef _USE_HPM_
 			if (LSRK3data::step_id>0) 			HPM_Stop("Update");
 #endif
@@ -330,6 +440,13 @@ public:
     {
 		if (verbosity) cout << "GSYNCH " << parser("-gsync").asInt(omp_get_max_threads()) << endl;
 		
+		//halo exchange: p2p or neighborhood (MPI-3 neighborhood collectives)
+		const string halo = parser("-halo").asString("p2p");
+		grid.setNeighborhoodCollectives(halo == "neighborhood");
+		grid.setSharedMemoryHalo(parser("-shmhalo").asBool(false));
+		
+		if (verbosity) cout << "HALO " << halo << (parser("-shmhalo").asBool(false) ? ", node-local through shared memory" : "") << endl;
+		
 #ifndef _SEQUOIA_	
 		static const int pehflag = 0; 
 		LSRK3MPIdata::hist_group.Init(8, parser("-report").asInt(1), pehflag); // peh
@@ -395,10 +512,14 @@ public:
 		
 		//now we perform an entire RK step
 		if (parser("-kernels").asString("cpp")=="cpp")
-			LSRKstepMPI<Convection_CPP, Update_CPP>(grid, dt/h, current_time);
+			nextSOS = LSRKstepMPI<Convection_CPP, Update_CPP>(grid, dt/h, current_time).maxsos;
 #if defined(_QPX_) || defined(_QPXEMU_)
 		else if (parser("-kernels").asString("cpp")=="qpx")
-			LSRKstepMPI<Convection_QPX, Update_QPX>(grid, dt/h, current_time);
+			nextSOS = LSRKstepMPI<Convection_QPX, Update_QPX>(grid, dt/h, current_time).maxsos;
+#endif
+#ifdef _AVX_
+		else if (parser("-kernels").asString("cpp")=="avx")
+			nextSOS = LSRKstepMPI<Convection_AVX, Update_AVX>(grid, dt/h, current_time).maxsos;
 #endif
 		else
 	    {
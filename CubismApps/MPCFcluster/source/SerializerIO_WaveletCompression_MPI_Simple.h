@@ -16,6 +16,8 @@
 
 using namespace std;
 
+#include <BlockSchedule.h>
+
 #include "WaveletSerializationTypes.h"
 #include "FullWaveletTransform.h"
 #include "WaveletCompressor.h"
@@ -143,10 +145,14 @@ protected:
 	}
 	
 	template<int channel>
-	void _compress(const vector<BlockInfo>& vInfo, const int NBLOCKS, IterativeStreamer streamer)
+	void _compress(const vector<BlockInfo>& vInfo, const GridType& grid, IterativeStreamer streamer)
 	{
+		BlockSchedule schedule(vInfo, grid);
+		
 #pragma omp parallel  
 		{			
+		  NUMAPartition::bind();
+		  
 		  const int tid = omp_get_thread_num();
 
 		  CompressionBuffer & mybuf = workbuffer[tid];
@@ -157,8 +163,7 @@ protected:
 			Timer timer;
 			timer.start();
 			
-#pragma omp for
-			for(int i = 0; i < NBLOCKS; ++i)
+			for(int i = schedule.next(); i >= 0; i = schedule.next())
 			{
 				Timer tw; tw.start();
 				
@@ -321,7 +326,7 @@ protected:
 	template<int channel>
 	void _write(GridType & inputGrid, string fileName, IterativeStreamer streamer)
 	{				
-		const vector<BlockInfo> infos = inputGrid.getBlocksInfo();
+		const vector<BlockInfo>& infos = inputGrid.getBlocksInfo();
 		const int NBLOCKS = infos.size();
 		
 		//prepare the headers
@@ -391,7 +396,7 @@ protected:
 			
 			lut_compression.clear();
 			
-			_compress<channel>(infos, infos.size(), streamer);
+			_compress<channel>(infos, inputGrid, streamer);
 			
 			//manipulate the file data (allmydata, lut_compression, myblockindices)
 			//so that they are file-friendly
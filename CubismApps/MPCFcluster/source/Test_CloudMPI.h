@@ -28,7 +28,18 @@
 //typedef BlockLabMPI< BlockLabCloudLaplace< FluidBlock, std::allocator> > LabLaplace;
 
 
-typedef BlockLabMPI< BlockLab< FluidBlock, std::allocator> > LabLaplace;
+//the relaxation reads the energy only: the lab holds that component alone (see GaussSeidel::stencil)
+struct EnergyElement
+{
+	Real energy;
+	
+	void clear() { energy = 0; }
+};
+
+typedef BlockLabMPI< BlockLab< FluidBlock, BlockAllocator, EnergyElement> > LabLaplace;
+
+//the lab of whole FluidElements, the reference of -relaxcheck
+typedef BlockLabMPI< BlockLab< FluidBlock, BlockAllocator> > LabLaplaceFull;
 
 template<typename TLab>
 struct GaussSeidel // , not. just 2ndorder bspline convolution
@@ -38,13 +49,13 @@ struct GaussSeidel // , not. just 2ndorder bspline convolution
     int stencil_start[3];
     int stencil_end[3];
     
-    GaussSeidel(): stencil(-1, -1, -1, +2, +2, +2, true, 2, 4, 7)
+    GaussSeidel(): stencil(-1, -1, -1, +2, +2, +2, true, 1, 4)
     {
         stencil_start[0] = stencil_start[1] = stencil_start[2] = -1;
         stencil_end[0] = stencil_end[1] = stencil_end[2] = 2;
     }
     
-    GaussSeidel(const GaussSeidel& c): stencil(-1, -1, -1, +2, +2, +2, true, 2, 4, 7)
+    GaussSeidel(const GaussSeidel& c): stencil(-1, -1, -1, +2, +2, +2, true, 1, 4)
     {
         stencil_start[0] = stencil_start[1] = stencil_start[2] = -1;
         stencil_end[0] = stencil_end[1] = stencil_end[2] = 2;
@@ -65,29 +76,29 @@ struct GaussSeidel // , not. just 2ndorder bspline convolution
 							for(int dx=-1; dx < 2; ++dx)
 								s += w[dx + 1]* w[dy + 1]* w[dz + 1] * lab(ix + dx, iy + dy, iz + dz).energy;
 					
-					o(ix,iy,iz).dummy = s;
+					o.tmp[iz][iy][ix][0] = s; //tmp is free during the setup, data may not have a spare slot
 				}
     }
 };
 
 template<typename Lab, typename Operator, typename TGrid>
-void _process_laplace(vector<BlockInfo>& vInfo, Operator rhs, TGrid& grid, const Real t=0, bool tensorial=false)
+void _process_laplace(const vector<BlockInfo>& vInfo, Operator rhs, TGrid& grid, const Real t=0, bool tensorial=false)
 {
+    BlockSchedule schedule(vInfo, grid);
+    
 #pragma omp parallel
     {
-        vector<BlockInfo>myInfo = vInfo;
-        BlockInfo * ary = &myInfo.front();
+        NUMAPartition::bind();
+        
+        const BlockInfo * const ary = &vInfo.front();
         
         Operator myrhs = rhs;
-        Lab mylab;
         
         const SynchronizerMPI& synch = grid.get_SynchronizerMPI(myrhs);
         
-        const int N = vInfo.size();
-        mylab.prepare(grid, synch);
+        Lab& mylab = LabPool<Lab>::get(grid, synch);
         
-#pragma omp for schedule(runtime)
-        for(int i=0; i<N; i++)
+        for(int i=schedule.next(); i>=0; i=schedule.next())
         {
             mylab.load(ary[i], t);
             myrhs(mylab, ary[i], *(FluidBlock*)ary[i].ptrBlock);
@@ -98,20 +109,20 @@ void _process_laplace(vector<BlockInfo>& vInfo, Operator rhs, TGrid& grid, const
 template <typename TGrid>
 void _process_update(const vector<BlockInfo>& vInfo, TGrid& grid)
 {
+    BlockSchedule schedule(vInfo, grid);
+    
 #pragma omp parallel
     {
-        vector<BlockInfo>myInfo = vInfo;
-        const int N = vInfo.size();
+        NUMAPartition::bind();
         
-#pragma omp for schedule(runtime)
-        for(int i=0; i<N; i++)
+        for(int i=schedule.next(); i>=0; i=schedule.next())
         {
-			FluidBlock& b = *(FluidBlock*)myInfo[i].ptrBlock;
+			FluidBlock& b = *(FluidBlock*)vInfo[i].ptrBlock;
 			
             for(int iz=0; iz<FluidBlock::sizeZ; iz++)
 				for(int iy=0; iy<FluidBlock::sizeY; iy++)
 					for(int ix=0; ix<FluidBlock::sizeX; ix++)
-						b(ix,iy,iz).energy = b(ix,iy,iz).dummy;
+						b(ix,iy,iz).energy = b.tmp[iz][iy][ix][0];
         }
     }
 }
@@ -152,9 +163,11 @@ public:
         t_sbmpi = new Test_ShockBubbleMPI(isroot, argc, argv);
 	}
     
-    void _relax_pressure(G & grid)
+    //the smoothed energy into tmp[..][0]
+    template<typename Lab>
+    void _smooth(G & grid)
     {
-        GaussSeidel< LabLaplace > gs;
+        GaussSeidel< Lab > gs;
 		
         SynchronizerMPI& synch = ((G&)grid).sync(gs);
         
@@ -163,9 +176,55 @@ public:
             //if (isroot) printf("One avail loop of gs ");
             vector<BlockInfo> avail = synch.avail(1);
             
-            _process_laplace< LabLaplace >(avail, gs, (G&)grid);
+            _process_laplace< Lab >(avail, gs, (G&)grid);
             //if (isroot) printf("... done\n");            
         }
+    }
+    
+    static vector<Real> _smoothed(G & grid)
+    {
+        const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
+        
+        vector<Real> retval;
+        
+        for(int i=0; i<(int)vInfo.size(); i++)
+        {
+            const FluidBlock& b = *(FluidBlock*)vInfo[i].ptrBlock;
+            
+            for(int iz=0; iz<FluidBlock::sizeZ; iz++)
+                for(int iy=0; iy<FluidBlock::sizeY; iy++)
+                    for(int ix=0; ix<FluidBlock::sizeX; ix++)
+                        retval.push_back(b.tmp[iz][iy][ix][0]);
+        }
+        
+        return retval;
+    }
+    
+    //check: the energy is also smoothed with the lab of whole FluidElements, the two must agree exactly
+    void _relax_pressure(G & grid, const bool check=false)
+    {
+        vector<Real> ref;
+        
+        if (check)
+        {
+            _smooth< LabLaplaceFull >(grid);
+            ref = _smoothed(grid);
+        }
+        
+        _smooth< LabLaplace >(grid);
+        
+        if (check)
+        {
+            const int mywrong = ref != _smoothed(grid);
+            int nwrong = 0;
+            
+            grid.getCartComm().Allreduce(&mywrong, &nwrong, 1, MPI::INT, MPI::SUM);
+            
+            if (isroot)
+                printf("RELAXATION CHECK: %s\n", nwrong == 0 ? "passed" : "FAILED");
+            
+            if (nwrong > 0) abort();
+        }
         
         _process_update(grid.getBlocksInfo(), grid);
     }
@@ -271,8 +330,13 @@ public:
             if (isroot) 
 				cout << "relaxing pressure a little bit..."<< endl;
             
-            //for(int i = 0; i < 2; ++i)
-			//		_relax_pressure(*grid);
+            //off by default, -relax 2 gives the smoothing of the original setup.
+            //-relaxcheck 1 compares the narrow lab of the smoothing with the full one
+            const int nrelax = parser("-relax").asInt(0);
+            const bool bRelaxCheck = parser("-relaxcheck").asBool(false);
+            
+            for(int i = 0; i < nrelax; ++i)
+                _relax_pressure(*grid, bRelaxCheck);
             
             if (isroot) 
 				cout << "done!"<< endl;
@@ -285,6 +349,8 @@ public:
             if (isroot) 
 				printf("done\n");
         }
+		
+		stepper->invalidate_sos();
 	}
     
 	void run()
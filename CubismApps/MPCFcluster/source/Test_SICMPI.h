@@ -64,6 +64,8 @@ public:
 		}
 		else
 			_ic(*grid);
+		
+		stepper->invalidate_sos();
 	}	
     
 	void run()
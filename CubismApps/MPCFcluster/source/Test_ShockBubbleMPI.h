@@ -62,6 +62,8 @@ public:
 		}
 		else
 			_ic(*grid);
+		
+		stepper->invalidate_sos();
 	}	
     
     void dumpStatistics(G& grid, const int step_id, const Real t, const Real dt)
@@ -181,6 +181,9 @@ public:
 			_ic(*grid);
 			dump(*grid, step_id, "mpi_initialcondition");
 		}
+		
+		//the grid state was replaced after the stepper was created
+		mystepper->invalidate_sos();
 	}	
 	
 	void run()
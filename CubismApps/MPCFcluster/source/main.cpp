@@ -29,11 +29,19 @@ Simulation * sim = NULL;
 
 int main (int argc, const char ** argv) 
 {
-	MPI::Init();
-//	MPI::Init_thread(MPI_THREAD_MULTIPLE);
-	
+	//the halo exchange calls MPI from the master thread within parallel regions
+	const int provided = MPI::Init_thread(MPI_THREAD_FUNNELED);
+
 	const bool isroot = MPI::COMM_WORLD.Get_rank() == 0;
 
+	if (provided < MPI_THREAD_FUNNELED)
+	{
+		if (isroot)
+			cout << "MPI_THREAD_FUNNELED is not supported by the MPI library, aborting now." << endl;
+
+		MPI::COMM_WORLD.Abort(1);
+	}
+
 	if (isroot)
 		cout << "=================  MPCF cluster =================" << endl;
 	
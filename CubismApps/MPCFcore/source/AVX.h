@@ -0,0 +1,68 @@
+/*
+ *  AVX.h
+ *  MPCFcore
+ *
+ */
+
+#pragma once
+
+#include "common.h"
+#include "SIMD.h"
+
+//the vector kernels are written once against SIMD<Real, LANES>.
+//the register width is the widest one targeted by the compiler:
+//AVX-512 (-D_AVX512_), AVX2 or, as a fallback, SSE2
+
+#if defined(_AVX512_)
+#define _AVXBYTES_ 64
+#elif defined(__AVX2__)
+#define _AVXBYTES_ 32
+#else
+#define _AVXBYTES_ 16
+#endif
+
+#ifdef _FLOAT_PRECISION_
+#define _AVXLANES_ (_AVXBYTES_ / 4)
+#else
+#define _AVXLANES_ (_AVXBYTES_ / 8)
+#endif
+
+#if _BLOCKSIZE_ % _AVXLANES_ != 0
+#error BLOCKSIZE NOT GOOD FOR AVX
+#endif
+
+enum { AVXLANES = _AVXLANES_ };
+
+typedef SIMD<Real, AVXLANES> AVXSIMD;
+typedef AVXSIMD::type vecreal;
+typedef AVXSIMD::mask vecmask;
+typedef AVXSIMD::index vecidx;
+
+inline vecreal avx_load(const Real * const p) { return AVXSIMD::load(p); }
+inline vecreal avx_loadu(const Real * const p) { return AVXSIMD::loadu(p); }
+inline void avx_store(Real * const p, const vecreal a) { AVXSIMD::store(p, a); }
+inline void avx_storeu(Real * const p, const vecreal a) { AVXSIMD::storeu(p, a); }
+inline vecreal avx_splat(const Real a) { return AVXSIMD::splat(a); }
+inline vecreal avx_add(const vecreal a, const vecreal b) { return AVXSIMD::add(a, b); }
+inline vecreal avx_sub(const vecreal a, const vecreal b) { return AVXSIMD::sub(a, b); }
+inline vecreal avx_mul(const vecreal a, const vecreal b) { return AVXSIMD::mul(a, b); }
+inline vecreal avx_div(const vecreal a, const vecreal b) { return AVXSIMD::div(a, b); }
+inline vecreal avx_madd(const vecreal a, const vecreal b, const vecreal c) { return AVXSIMD::madd(a, b, c); }
+inline vecreal avx_msub(const vecreal a, const vecreal b, const vecreal c) { return AVXSIMD::msub(a, b, c); }
+inline vecreal avx_nmsub(const vecreal a, const vecreal b, const vecreal c) { return AVXSIMD::nmsub(a, b, c); }
+inline vecreal avx_min(const vecreal a, const vecreal b) { return AVXSIMD::min(a, b); }
+inline vecreal avx_max(const vecreal a, const vecreal b) { return AVXSIMD::max(a, b); }
+inline vecreal avx_sqrt(const vecreal a) { return AVXSIMD::sqrt(a); }
+inline vecreal avx_abs(const vecreal a) { return AVXSIMD::abs(a); }
+inline vecmask avx_cmpgt(const vecreal a, const vecreal b) { return AVXSIMD::cmpgt(a, b); }
+inline vecmask avx_cmplt(const vecreal a, const vecreal b) { return AVXSIMD::cmplt(a, b); }
+inline vecreal avx_sel(const vecmask m, const vecreal a, const vecreal b) { return AVXSIMD::sel(m, a, b); }
+inline vecidx avx_stride(const int s) { return AVXSIMD::stride(s); }
+inline vecreal avx_gather(const Real * const p, const vecidx idx) { return AVXSIMD::gather(p, idx); }
+inline void avx_scatter(Real * const p, const vecidx idx, const vecreal a) { AVXSIMD::scatter(p, idx, a); }
+inline Real avx_hmax(const vecreal a) { return AVXSIMD::hmax(a); }
+
+//the SOA2D pitches have to be a multiple of the register width
+#if _ALIGNBYTES_ % _AVXBYTES_ != 0
+#error ALIGNBYTES NOT GOOD FOR AVX
+#endif
@@ -0,0 +1,252 @@
+/*
+ *  Convection_AVX.h
+ *  MPCFcore
+ *
+ */
+
+#pragma once
+
+#include "Convection_CPP.h"
+#include "AVX.h"
+#include "WenoSOA2D_AVX.h"
+#include "HLLESOA2D_AVX.h"
+#include "DivSOA2D_AVX.h"
+
+class Convection_AVX : public Convection_CPP
+{
+	friend class Convection_CPP;
+
+	enum { LAST = _BLOCKSIZE_ + 3 - AVXLANES };
+
+	//the AVXLANES points from in (gptfloats apart) to the points dx.. of row dy of the rings
+	void _convert_lanes(const Real * const in, const vecidx stride, const int dx, const int dy)
+	{
+		const vecreal M_1_2 = avx_splat(-0.5);
+		const vecreal F_1 = avx_splat(1);
+
+		InputSOA& rho = this->rho.ring.ref(), &u = this->u.ring.ref(), &v = this->v.ring.ref(),
+		&w = this->w.ring.ref(), &p = this->p.ring.ref(), &G = this->G.ring.ref(), &P = this->P.ring.ref();
+
+		const vecreal r = avx_gather(in, stride);
+		const vecreal ru = avx_gather(in + 1, stride);
+		const vecreal rv = avx_gather(in + 2, stride);
+		const vecreal rw = avx_gather(in + 3, stride);
+		const vecreal s = avx_gather(in + 4, stride);
+		const vecreal myG = avx_gather(in + 5, stride);
+		const vecreal myP = avx_gather(in + 6, stride);
+
+		const vecreal inv_r = avx_div(F_1, r);
+		const vecreal speed2 = avx_madd(ru, ru, avx_madd(rv, rv, avx_mul(rw, rw)));
+		const vecreal myp = avx_div(avx_madd(avx_mul(M_1_2, inv_r), speed2, avx_sub(s, myP)), myG);
+
+		avx_storeu(&rho.ref(dx, dy), r);
+		avx_storeu(&u.ref(dx, dy), avx_mul(ru, inv_r));
+		avx_storeu(&v.ref(dx, dy), avx_mul(rv, inv_r));
+		avx_storeu(&w.ref(dx, dy), avx_mul(rw, inv_r));
+		avx_storeu(&p.ref(dx, dy), myp);
+		avx_storeu(&G.ref(dx, dy), myG);
+		avx_storeu(&P.ref(dx, dy), myP);
+	}
+
+	//the lab is AoS: each vector gathers one quantity of AVXLANES consecutive points
+	void _convert(const Real * const gptfirst, const int gptfloats, const int rowgpts)
+	{
+		const vecidx stride = avx_stride(gptfloats);
+
+		for(int dy=-3; dy<_BLOCKSIZE_+3; dy++)
+			for(int sx=-3; sx<_BLOCKSIZE_+3; sx+=AVXLANES)
+			{
+				const int dx = std::min(sx, (int)LAST);
+
+				_convert_lanes(gptfirst + gptfloats*(dx + 3 + (dy + 3)*rowgpts), stride, dx, dy);
+			}
+	}
+
+	//split source: the vectors inside the block are gathered in place, those with ghosts
+	//from a copy of their points. every point is converted as in the AoS version
+	void _convert(const HaloSource& src, const int dz)
+	{
+		const int gptfloats = src.gptfloats;
+		const vecidx stride = avx_stride(gptfloats);
+		const vecidx stagestride = avx_stride(8);
+
+		Real stage[AVXLANES * 8];
+
+		for(int dy=-3; dy<_BLOCKSIZE_+3; dy++)
+		{
+			const Real * pieces[3];
+			src.row(dy, dz, pieces);
+
+			for(int sx=-3; sx<_BLOCKSIZE_+3; sx+=AVXLANES)
+			{
+				const int dx = std::min(sx, (int)LAST);
+
+				if (dx >= 0 && dx + AVXLANES <= _BLOCKSIZE_)
+					_convert_lanes(pieces[1] + gptfloats * dx, stride, dx, dy);
+				else
+				{
+					for(int i=0; i<AVXLANES; i++)
+					{
+						const Real * const pt = src.point(pieces, dx + i);
+
+						for(int c=0; c<7; c++)
+							stage[8 * i + c] = pt[c];
+					}
+
+					_convert_lanes(stage, stagestride, dx, dy);
+				}
+			}
+		}
+	}
+
+	void _xrhs()
+	{
+		DivSOA2D_AVX divtor;
+		divtor.xrhs(rho.flux(), rho.rhs);
+		divtor.xrhs(u.flux(), u.rhs);
+		divtor.xrhs(v.flux(), v.rhs);
+		divtor.xrhs(w.flux(), w.rhs);
+		divtor.xrhs(p.flux(), p.rhs);
+		divtor.xrhs(G.flux(), G.rhs);
+		divtor.xrhs(P.flux(), P.rhs);
+	}
+
+	void _yrhs()
+	{
+		DivSOA2D_AVX divtor;
+		divtor.yrhs(rho.flux(), rho.rhs);
+		divtor.yrhs(u.flux(), u.rhs);
+		divtor.yrhs(v.flux(), v.rhs);
+		divtor.yrhs(w.flux(), w.rhs);
+		divtor.yrhs(p.flux(), p.rhs);
+		divtor.yrhs(G.flux(), G.rhs);
+		divtor.yrhs(P.flux(), P.rhs);
+	}
+
+	void _zrhs()
+	{
+		DivSOA2D_AVX divtor;
+		divtor.zrhs(rho.flux(-1), rho.flux(0), rho.rhs);
+		divtor.zrhs(u.flux(-1), u.flux(0), u.rhs);
+		divtor.zrhs(v.flux(-1), v.flux(0), v.rhs);
+		divtor.zrhs(w.flux(-1), w.flux(0), w.rhs);
+		divtor.zrhs(p.flux(-1), p.flux(0), p.rhs);
+		divtor.zrhs(G.flux(-1), G.flux(0), G.rhs);
+		divtor.zrhs(P.flux(-1), P.flux(0), P.rhs);
+	}
+
+	void _copyback(Real * const gptfirst, const int gptfloats, const int rowgpts)
+	{
+		const vecidx stride = avx_stride(gptfloats);
+		const vecreal mya = avx_splat(a);
+		const vecreal lambda = avx_splat(dtinvh);
+		const vecreal M_1_6 = avx_splat(-1./6);
+
+		for(int iy=0; iy<OutputSOA::NY; iy++)
+			for(int ix=0; ix<OutputSOA::NX; ix+=AVXLANES)
+			{
+				Real * const out = gptfirst + gptfloats*(ix + iy*rowgpts);
+
+				const vecreal mydivu = avx_load(divu.ptr(ix, iy));
+				const vecreal rhsG = avx_madd(avx_mul(M_1_6, avx_load(sumG.ptr(ix, iy))), mydivu, avx_load(G.rhs.ptr(ix, iy)));
+				const vecreal rhsP = avx_madd(avx_mul(M_1_6, avx_load(sumP.ptr(ix, iy))), mydivu, avx_load(P.rhs.ptr(ix, iy)));
+
+				avx_scatter(out, stride, avx_msub(mya, avx_gather(out, stride), avx_mul(lambda, avx_load(rho.rhs.ptr(ix, iy)))));
+				avx_scatter(out + 1, stride, avx_msub(mya, avx_gather(out + 1, stride), avx_mul(lambda, avx_load(u.rhs.ptr(ix, iy)))));
+				avx_scatter(out + 2, stride, avx_msub(mya, avx_gather(out + 2, stride), avx_mul(lambda, avx_load(v.rhs.ptr(ix, iy)))));
+				avx_scatter(out + 3, stride, avx_msub(mya, avx_gather(out + 3, stride), avx_mul(lambda, avx_load(w.rhs.ptr(ix, iy)))));
+				avx_scatter(out + 4, stride, avx_msub(mya, avx_gather(out + 4, stride), avx_mul(lambda, avx_load(p.rhs.ptr(ix, iy)))));
+				avx_scatter(out + 5, stride, avx_msub(mya, avx_gather(out + 5, stride), avx_mul(lambda, rhsG)));
+				avx_scatter(out + 6, stride, avx_msub(mya, avx_gather(out + 6, stride), avx_mul(lambda, rhsP)));
+			}
+	}
+
+	void _xflux(const int relid)
+	{
+		{
+			WenoSOA2D_AVX wenoizer;
+
+			wenoizer.xcompute(rho.ring(relid), rho.weno.ref(0), rho.weno.ref(1));
+			wenoizer.xcompute(u.ring(relid), u.weno.ref(0), u.weno.ref(1));
+			wenoizer.xcompute(v.ring(relid), v.weno.ref(0), v.weno.ref(1));
+			wenoizer.xcompute(w.ring(relid), w.weno.ref(0), w.weno.ref(1));
+			wenoizer.xcompute(p.ring(relid), p.weno.ref(0), p.weno.ref(1));
+			wenoizer.xcompute(G.ring(relid), G.weno.ref(0), G.weno.ref(1));
+			wenoizer.xcompute(P.ring(relid), P.weno.ref(0), P.weno.ref(1));
+		}
+
+		HLLESOA2D_AVX hllezator;
+		hllezator.all(rho.weno(0), rho.weno(1), u.weno(0), u.weno(1), v.weno(0), v.weno(1), w.weno(0), w.weno(1), p.weno(0), p.weno(1), G.weno(0), G.weno(1), P.weno(0), P.weno(1), charvel.ref(0), charvel.ref(1), rho.flux.ref(), u.flux.ref(), v.flux.ref(), w.flux.ref(), p.flux.ref(), G.flux.ref(), P.flux.ref());
+
+		DivSOA2D_AVX divtor;
+		divtor.xextraterm(u.weno(0), u.weno(1), G.weno(0), G.weno(1), P.weno(0), P.weno(1), charvel(0), charvel(1), divu, sumG, sumP);
+	}
+
+	void _yflux(const int relid)
+	{
+		{
+			WenoSOA2D_AVX wenoizer;
+
+			wenoizer.ycompute(rho.ring(relid), rho.weno.ref(0), rho.weno.ref(1));
+			wenoizer.ycompute(u.ring(relid), u.weno.ref(0), u.weno.ref(1));
+			wenoizer.ycompute(v.ring(relid), v.weno.ref(0), v.weno.ref(1));
+			wenoizer.ycompute(w.ring(relid), w.weno.ref(0), w.weno.ref(1));
+			wenoizer.ycompute(p.ring(relid), p.weno.ref(0), p.weno.ref(1));
+			wenoizer.ycompute(G.ring(relid), G.weno.ref(0), G.weno.ref(1));
+			wenoizer.ycompute(P.ring(relid), P.weno.ref(0), P.weno.ref(1));
+		}
+
+		HLLESOA2D_AVX hllezator;
+		hllezator.all(rho.weno(0), rho.weno(1), v.weno(0), v.weno(1), u.weno(0), u.weno(1), w.weno(0), w.weno(1), p.weno(0), p.weno(1), G.weno(0), G.weno(1), P.weno(0), P.weno(1), charvel.ref(0), charvel.ref(1), rho.flux.ref(), v.flux.ref(), u.flux.ref(), w.flux.ref(), p.flux.ref(), G.flux.ref(), P.flux.ref());
+
+		DivSOA2D_AVX divtor;
+		divtor.yextraterm(v.weno(0), v.weno(1), G.weno(0), G.weno(1), P.weno(0), P.weno(1), charvel(0), charvel(1), divu, sumG, sumP);
+	}
+
+	void _zflux(const int relid)
+	{
+		{
+			WenoSOA2D_AVX wenoizer;
+
+			wenoizer.zcompute(relid, rho.ring, rho.weno.ref(0), rho.weno.ref(1));
+			wenoizer.zcompute(relid, u.ring, u.weno.ref(0), u.weno.ref(1));
+			wenoizer.zcompute(relid, v.ring, v.weno.ref(0), v.weno.ref(1));
+			wenoizer.zcompute(relid, w.ring, w.weno.ref(0), w.weno.ref(1));
+			wenoizer.zcompute(relid, p.ring, p.weno.ref(0), p.weno.ref(1));
+			wenoizer.zcompute(relid, G.ring, G.weno.ref(0), G.weno.ref(1));
+			wenoizer.zcompute(relid, P.ring, P.weno.ref(0), P.weno.ref(1));
+		}
+
+		HLLESOA2D_AVX hllezator;
+		hllezator.all(rho.weno(0), rho.weno(1), w.weno(0), w.weno(1), u.weno(0), u.weno(1), v.weno(0), v.weno(1), p.weno(0), p.weno(1), G.weno(0), G.weno(1), P.weno(0), P.weno(1), charvel.ref(0), charvel.ref(1), rho.flux.ref(), w.flux.ref(), u.flux.ref(), v.flux.ref(), p.flux.ref(), G.flux.ref(), P.flux.ref());
+
+		DivSOA2D_AVX divtor;
+		divtor.zextraterm(w.weno(-2), w.weno(-1), w.weno(0), w.weno(1), G.weno(-1), G.weno(0), P.weno(-1), P.weno(0), charvel(-2), charvel(-1), charvel(0), charvel(1), divu, sumG, sumP);
+	}
+
+public:
+
+	Convection_AVX(const Real a, const Real dtinvh): Convection_CPP(a, dtinvh) {}
+
+	void compute(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
+				 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, AoSInput(srcfirst, srcfloats, rowsrcs, slicesrcs), dstfirst, dstfloats, rowdsts, slicedsts);
+	}
+
+	void compute(const InputSOASlice * const srcfirst, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, srcfirst, dstfirst, dstfloats, rowdsts, slicedsts);
+	}
+
+	void compute(const HaloSource& src, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, src, dstfirst, dstfloats, rowdsts, slicedsts);
+	}
+
+	void compute_zstream(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
+						 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, AoSInput(srcfirst, srcfloats, rowsrcs, slicesrcs), dstfirst, dstfloats, rowdsts, slicedsts, true);
+	}
+};
@@ -24,34 +24,23 @@ Convection_CPP::Convection_CPP(const Real a, const Real dtinvh): a(a), dtinvh(dt
 void Convection_CPP::compute(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
 							 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
 {
-	for(int islice=0; islice<5; islice++)
-	{
-		_convert(srcfirst+islice*srcfloats*slicesrcs, srcfloats, rowsrcs);
-		_next();
-	}
-	
-	_convert(srcfirst + 5*srcfloats*slicesrcs, srcfloats, rowsrcs);
-    
-   	_zflux(-2);
-	_flux_next();
-    
-	for(int islice=0; islice<_BLOCKSIZE_; islice++)
-	{
-        _xflux(-2);
-        _xrhs();
-        
-        _yflux(-2);
-        _yrhs();
-        
-        _next();
-        _convert(srcfirst + (islice+6)*srcfloats*slicesrcs, srcfloats, rowsrcs);
-		
-        _zflux(-2);
-        _zrhs();
-        
-        _copyback(dstfirst + islice*dstfloats*slicedsts, dstfloats, rowdsts);
-        _flux_next();
-	}
+	_sweep(*this, AoSInput(srcfirst, srcfloats, rowsrcs, slicesrcs), dstfirst, dstfloats, rowdsts, slicedsts);
+}
+
+void Convection_CPP::compute(const InputSOASlice * const srcfirst, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+{
+	_sweep(*this, srcfirst, dstfirst, dstfloats, rowdsts, slicedsts);
+}
+
+void Convection_CPP::compute(const HaloSource& src, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+{
+	_sweep(*this, src, dstfirst, dstfloats, rowdsts, slicedsts);
+}
+
+void Convection_CPP::compute_zstream(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
+									 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+{
+	_sweep(*this, AoSInput(srcfirst, srcfloats, rowsrcs, slicesrcs), dstfirst, dstfloats, rowdsts, slicedsts, true);
 }
 
 void Convection_CPP::hpc_info(float& flop_convert, int& traffic_convert,
@@ -196,6 +185,33 @@ void Convection_CPP::_convert(const Real * const gptfirst, const int gptfloats,
 		}
 }
 
+void Convection_CPP::_convert(const HaloSource& src, const int dz)
+{
+	InputSOA& rho = this->rho.ring.ref(), &u = this->u.ring.ref(), &v = this->v.ring.ref(),
+	&w = this->w.ring.ref(), &p = this->p.ring.ref(), &G = this->G.ring.ref();
+    
+	InputSOA& P = this->P.ring.ref();
+	
+	for(int dy=-3; dy<_BLOCKSIZE_+3; dy++)
+	{
+		const Real * pieces[3];
+		src.row(dy, dz, pieces);
+		
+		for(int dx=-3; dx<_BLOCKSIZE_+3; dx++)
+		{
+			AssumedType pt = *(AssumedType*)src.point(pieces, dx);
+			
+			rho.ref(dx, dy) = pt.r;
+			u.ref(dx, dy) = pt.u/pt.r;
+			v.ref(dx, dy) = pt.v/pt.r;
+			w.ref(dx, dy) = pt.w/pt.r;
+			p.ref(dx, dy) = (pt.s - ( (pt.u*pt.u + pt.v*pt.v + pt.w*pt.w)*(((Real)0.5)/pt.r)+pt.P ))/pt.G;
+			G.ref(dx, dy) = pt.G;
+			P.ref(dx, dy) = pt.P;
+		}
+	}
+}
+
 inline Real weno_minus(const Real a, const Real b, const Real c, const Real d, const Real e) //82 FLOP
 {
   	const Real is0 = a*(a*(Real)(4./3.)  - b*(Real)(19./3.)  + c*(Real)(11./3.)) + b*(b*(Real)(25./3.)  - c*(Real)(31./3.)) + c*c*(Real)(10./3.);
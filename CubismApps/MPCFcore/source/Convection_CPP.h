@@ -27,6 +27,17 @@ public:
 	void compute(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
 				 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts);
 	
+	//same as compute(.), the source being the BLOCKSIZE+6 slices of a SoA lab, from z = -3
+	void compute(const InputSOASlice * const srcfirst, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts);
+	
+	//same as compute(.), the block and its ghosts being read in place (see HaloSource)
+	void compute(const HaloSource& src, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts);
+	
+	//same as compute(.) for the z-neighbor (z+1) of the last block computed by this instance:
+	//the warm-up slices are still in the rings and the lower z-ghosts of the source are not accessed
+	void compute_zstream(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
+						 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts);
+	
 	//this provides the amount of flops and memory traffic performed in compute(.)
 	static void hpc_info(float& flop_convert, int& traffic_convert,
 						 float& flop_weno, int& traffic_weno,
@@ -66,6 +77,95 @@ protected:
 	OutputSOA sumG, divu;
 	OutputSOA sumP;
 	
+	//input of _sweep: AoS grid points, converted slice by slice into the rings...
+	struct AoSInput
+	{
+		const Real * first;
+		int floats, row, slice;
+		
+		AoSInput(const Real * const first, const int floats, const int row, const int slice):
+		first(first), floats(floats), row(row), slice(slice) { }
+	};
+	
+	template<typename TKernel>
+	static void _load(TKernel& kernel, const AoSInput& input, const int islice)
+	{
+		kernel._convert(input.first + islice*input.floats*input.slice, input.floats, input.row);
+	}
+	
+	//...or the slices of a SoA lab, which are bound to the rings as they are...
+	template<typename TKernel>
+	static void _load(TKernel& kernel, const InputSOASlice * const input, const int islice)
+	{
+		kernel._bind(input[islice]);
+	}
+	
+	//...or the block and its ghosts where they are, converted piece by piece
+	template<typename TKernel>
+	static void _load(TKernel& kernel, const HaloSource& input, const int islice)
+	{
+		kernel._convert(input, islice - 3);
+	}
+	
+	//the slice-by-slice sweep of compute(.), the hooks are bound at compile time to those of TKernel
+	template<typename TKernel, typename TInput>
+	static void _sweep(TKernel& kernel, const TInput& input,
+					   Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts, const bool zstream=false)
+	{
+		if (zstream)
+		{
+			//the rings hold the slices -3..2 of this block and the flux at its bottom face.
+			//slices 0..2 are converted again: their x- and y-ghosts were edges in the previous lab
+			for(int islice=0; islice<4; islice++)
+				kernel._next();
+
+			for(int islice=3; islice<5; islice++)
+			{
+				_load(kernel, input, islice);
+				kernel._next();
+			}
+
+			_load(kernel, input, 5);
+		}
+		else
+		{
+			for(int islice=0; islice<5; islice++)
+			{
+				_load(kernel, input, islice);
+				kernel._next();
+			}
+
+			_load(kernel, input, 5);
+
+			kernel._zflux(-2);
+			kernel._flux_next();
+		}
+
+		for(int islice=0; islice<_BLOCKSIZE_; islice++)
+		{
+			kernel._xflux(-2);
+			kernel._xrhs();
+
+			kernel._yflux(-2);
+			kernel._yrhs();
+
+			kernel._next();
+			_load(kernel, input, islice+6);
+
+			kernel._zflux(-2);
+			kernel._zrhs();
+
+			kernel._copyback(dstfirst + islice*dstfloats*slicedsts, dstfloats, rowdsts);
+			kernel._flux_next();
+		}
+	}
+
+	void _bind(const InputSOASlice& slice)
+	{
+		rho.ring.bind(slice.rho); u.ring.bind(slice.u); v.ring.bind(slice.v); w.ring.bind(slice.w); p.ring.bind(slice.p); G.ring.bind(slice.G);
+		P.ring.bind(slice.P);
+	}
+
 	void _next()
 	{
 		rho.ring.next(); u.ring.next(); v.ring.next(); w.ring.next(); p.ring.next(); G.ring.next();
@@ -94,21 +194,21 @@ protected:
 							 , const TempSOA& Pm, const TempSOA& Pp
                              , const TempSOA& am, const TempSOA& ap);
     
-    virtual void _xextraterm_v2(const TempSOA& um, const TempSOA& up, const InputSOA& G, const InputSOA& P, const TempSOA& am, const TempSOA& ap);
+    void _xextraterm_v2(const TempSOA& um, const TempSOA& up, const InputSOA& G, const InputSOA& P, const TempSOA& am, const TempSOA& ap);
     
-	virtual void _yextraterm(const TempSOA& um, const TempSOA& up, const TempSOA& Gm, const TempSOA& Gp
+	void _yextraterm(const TempSOA& um, const TempSOA& up, const TempSOA& Gm, const TempSOA& Gp
 							 , const TempSOA& Pm, const TempSOA& Pp
                              , const TempSOA& am, const TempSOA& ap);
     
-    virtual void _yextraterm_v2(const TempSOA& um, const TempSOA& up, const InputSOA& G
+    void _yextraterm_v2(const TempSOA& um, const TempSOA& up, const InputSOA& G
                                 , const InputSOA& P
                                 , const TempSOA& am, const TempSOA& ap);
     
-	virtual void _zextraterm(const TempSOA& um0, const TempSOA& up0, const TempSOA& um1, const TempSOA& up1, const TempSOA& Gm, const TempSOA& Gp
+	void _zextraterm(const TempSOA& um0, const TempSOA& up0, const TempSOA& um1, const TempSOA& up1, const TempSOA& Gm, const TempSOA& Gp
 							 , const TempSOA& Pm, const TempSOA& Pp
                              , const TempSOA& am0, const TempSOA& ap0, const TempSOA& am1, const TempSOA& ap1);
 	
-    virtual void _zextraterm_v2(const TempSOA& um0, const TempSOA& up0, const TempSOA& um1, const TempSOA& up1,
+    void _zextraterm_v2(const TempSOA& um0, const TempSOA& up0, const TempSOA& um1, const TempSOA& up1,
                                 const InputSOA& G, const InputSOA& P,
                                 const TempSOA& am0, const TempSOA& ap0, const TempSOA& am1, const TempSOA& ap1, const bool bFirst=false);
     
@@ -151,20 +251,21 @@ protected:
 						 const TempSOA& aminus, const TempSOA& aplus,
 						 TempSOA& out);
     
-    virtual void _xdivergence(const TempSOA& flux, OutputSOA& rhs);
-	virtual void _ydivergence(const TempSOA& flux, OutputSOA& rhs);
-	virtual void _zdivergence(const TempSOA& fback, const TempSOA& fforward, OutputSOA& rhs);
+    void _xdivergence(const TempSOA& flux, OutputSOA& rhs);
+	void _ydivergence(const TempSOA& flux, OutputSOA& rhs);
+	void _zdivergence(const TempSOA& fback, const TempSOA& fforward, OutputSOA& rhs);
 
-    virtual void _convert(const Real * const gptfirst, const int gptfloats, const int rowgpts);
+    void _convert(const Real * const gptfirst, const int gptfloats, const int rowgpts);
+	void _convert(const HaloSource& src, const int dz);
 	
-	virtual void _xflux(const int relsliceid);
-	virtual void _yflux(const int relsliceid);
-	virtual void _zflux(const int relsliceid);
+	void _xflux(const int relsliceid);
+	void _yflux(const int relsliceid);
+	void _zflux(const int relsliceid);
     
-	virtual void _xrhs();
-	virtual void _yrhs();
-	virtual void _zrhs();
+	void _xrhs();
+	void _yrhs();
+	void _zrhs();
 	
-	virtual void _copyback(Real * const gptfirst, const int gptfloats, const int rowgpts);
+	void _copyback(Real * const gptfirst, const int gptfloats, const int rowgpts);
 };
 
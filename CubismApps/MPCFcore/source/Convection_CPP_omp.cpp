@@ -622,7 +622,6 @@ void Convection_CPP_omp::_copyback(Real * const gptfirst, const int gptfloats, c
 		}
 }
 
-#if 0
 void Convection_CPP_omp::_xflux(const int relid)
 {	
 	_xweno_minus(rho.ring(relid), rho.weno.ref(0));
@@ -743,4 +742,3 @@ void Convection_CPP_omp::_zrhs()
     _zdivergence(G.flux(-1), G.flux(0), G.rhs);
     _zdivergence(P.flux(-1), P.flux(0), P.rhs);
 }
-#endif
@@ -16,7 +16,9 @@
 #include "DivSOA2D_QPX.h"
 
 class Convection_QPX : public Convection_CPP
-{		
+{
+	friend class Convection_CPP;
+		
 	__align(_ALIGNBYTES_) struct TinyScratchPad { Real tmp[4][4];};
 	
 	void _qpx_convert_aligned(Real * const gptfirst, const int gptfloats, const int rowgpts,
@@ -102,6 +104,9 @@ class Convection_QPX : public Convection_CPP
 		
 	}
 	
+	//the split source (see HaloSource) is converted by the scalar code
+	using Convection_CPP::_convert;
+	
 	void _xrhs()
 	{
 		DivSOA2D_QPX divtor;
@@ -270,4 +275,26 @@ class Convection_QPX : public Convection_CPP
 public:
 	
 	Convection_QPX(const Real a, const Real dtinvh): Convection_CPP(a, dtinvh) {}
+
+	void compute(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
+				 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, AoSInput(srcfirst, srcfloats, rowsrcs, slicesrcs), dstfirst, dstfloats, rowdsts, slicedsts);
+	}
+
+	void compute(const InputSOASlice * const srcfirst, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, srcfirst, dstfirst, dstfloats, rowdsts, slicedsts);
+	}
+
+	void compute(const HaloSource& src, Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, src, dstfirst, dstfloats, rowdsts, slicedsts);
+	}
+
+	void compute_zstream(const Real * const srcfirst, const int srcfloats, const int rowsrcs, const int slicesrcs,
+						 Real * const dstfirst, const int dstfloats, const int rowdsts, const int slicedsts)
+	{
+		_sweep(*this, AoSInput(srcfirst, srcfloats, rowsrcs, slicesrcs), dstfirst, dstfloats, rowdsts, slicedsts, true);
+	}
 };
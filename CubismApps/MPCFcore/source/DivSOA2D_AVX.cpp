@@ -0,0 +1,142 @@
+/*
+ *  DivSOA2D_AVX.cpp
+ *  MPCFcore
+ *
+ */
+
+#include "DivSOA2D_AVX.h"
+
+enum {
+	SP = TempSOA::PITCH,
+	DP = OutputSOA::PITCH
+};
+
+//the y-quantities are stored transposed: a vector along y is added to a column of the output
+inline void _avx_addcolumn(const vecreal v, Real * const out)
+{
+	Real __attribute__((__aligned__(_AVXBYTES_))) tmp[AVXLANES];
+	avx_store(tmp, v);
+
+	for(int k = 0; k < AVXLANES; ++k)
+		out[k * DP] += tmp[k];
+}
+
+inline vecreal _avx_mixedterm(const vecreal am, const vecreal ap, const vecreal um, const vecreal up)
+{
+	return avx_div(avx_msub(ap, um, avx_mul(am, up)), avx_sub(ap, am));
+}
+
+inline vecreal _avx_mixedterm(const Real * const am, const Real * const ap, const Real * const um, const Real * const up)
+{
+	return _avx_mixedterm(avx_loadu(am), avx_loadu(ap), avx_loadu(um), avx_loadu(up));
+}
+
+void DivSOA2D_AVX::xrhs(const TempSOA& flux, OutputSOA& rhs) const
+{
+	const Real * const f = flux.ptr(0,0);
+	Real * const r = &rhs.ref(0,0);
+
+	for(int iy=0; iy<OutputSOA::NY; iy++)
+		for(int ix=0; ix<OutputSOA::NX; ix+=AVXLANES)
+		{
+			const Real * const entry = f + ix + SP*iy;
+			avx_store(r + ix + DP*iy, avx_sub(avx_loadu(entry + 1), avx_load(entry)));
+		}
+}
+
+void DivSOA2D_AVX::yrhs(const TempSOA& flux, OutputSOA& rhs) const
+{
+	const Real * const f = flux.ptr(0,0);
+	Real * const r = &rhs.ref(0,0);
+
+	for(int ix=0; ix<OutputSOA::NX; ix++)
+		for(int iy=0; iy<OutputSOA::NY; iy+=AVXLANES)
+		{
+			const Real * const entry = f + iy + SP*ix;
+			_avx_addcolumn(avx_sub(avx_loadu(entry + 1), avx_load(entry)), r + ix + DP*iy);
+		}
+}
+
+void DivSOA2D_AVX::zrhs(const TempSOA& fback, const TempSOA& fforward, OutputSOA& rhs) const
+{
+	const Real * const fb = fback.ptr(0,0);
+	const Real * const ff = fforward.ptr(0,0);
+	Real * const r = &rhs.ref(0,0);
+
+	for(int iy=0; iy<OutputSOA::NY; iy++)
+		for(int ix=0; ix<OutputSOA::NX; ix+=AVXLANES)
+		{
+			const vecreal result = avx_sub(avx_load(ff + ix + SP*iy), avx_load(fb + ix + SP*iy));
+			avx_store(r + ix + DP*iy, avx_add(avx_load(r + ix + DP*iy), result));
+		}
+}
+
+void DivSOA2D_AVX::xextraterm(const TempSOA& um, const TempSOA& up, const TempSOA& Gm, const TempSOA& Gp,
+							  const TempSOA& Pm, const TempSOA& Pp,
+							  const TempSOA& am, const TempSOA& ap,
+							  OutputSOA& divu, OutputSOA& sumG, OutputSOA& sumP) const
+{
+	for(int iy=0; iy<OutputSOA::NY; iy++)
+	{
+		const Real * const amptr = am.ptr(0, iy);
+		const Real * const apptr = ap.ptr(0, iy);
+		const Real * const umptr = um.ptr(0, iy);
+		const Real * const upptr = up.ptr(0, iy);
+
+		for(int ix=0; ix<OutputSOA::NX; ix+=AVXLANES)
+		{
+			const vecreal m0 = _avx_mixedterm(amptr + ix, apptr + ix, umptr + ix, upptr + ix);
+			const vecreal m1 = _avx_mixedterm(amptr + ix + 1, apptr + ix + 1, umptr + ix + 1, upptr + ix + 1);
+
+			avx_store(&divu.ref(ix, iy), avx_sub(m1, m0));
+			avx_store(&sumG.ref(ix, iy), avx_add(avx_load(Gp.ptr(ix, iy)), avx_loadu(Gm.ptr(ix, iy) + 1)));
+			avx_store(&sumP.ref(ix, iy), avx_add(avx_load(Pp.ptr(ix, iy)), avx_loadu(Pm.ptr(ix, iy) + 1)));
+		}
+	}
+}
+
+void DivSOA2D_AVX::yextraterm(const TempSOA& um, const TempSOA& up,
+							  const TempSOA& Gm, const TempSOA& Gp,
+							  const TempSOA& Pm, const TempSOA& Pp,
+							  const TempSOA& am, const TempSOA& ap,
+							  OutputSOA& divu, OutputSOA& sumG, OutputSOA& sumP) const
+{
+	for(int ix=0; ix<OutputSOA::NX; ix++)
+	{
+		const Real * const amptr = am.ptr(0, ix);
+		const Real * const apptr = ap.ptr(0, ix);
+		const Real * const umptr = um.ptr(0, ix);
+		const Real * const upptr = up.ptr(0, ix);
+
+		for(int iy=0; iy<OutputSOA::NY; iy+=AVXLANES)
+		{
+			const vecreal m0 = _avx_mixedterm(amptr + iy, apptr + iy, umptr + iy, upptr + iy);
+			const vecreal m1 = _avx_mixedterm(amptr + iy + 1, apptr + iy + 1, umptr + iy + 1, upptr + iy + 1);
+
+			_avx_addcolumn(avx_sub(m1, m0), &divu.ref(ix, iy));
+			_avx_addcolumn(avx_add(avx_load(Gp.ptr(iy, ix)), avx_loadu(Gm.ptr(iy, ix) + 1)), &sumG.ref(ix, iy));
+			_avx_addcolumn(avx_add(avx_load(Pp.ptr(iy, ix)), avx_loadu(Pm.ptr(iy, ix) + 1)), &sumP.ref(ix, iy));
+		}
+	}
+}
+
+void DivSOA2D_AVX::zextraterm(const TempSOA& um0, const TempSOA& up0, const TempSOA& um1, const TempSOA& up1,
+							  const TempSOA& Gm, const TempSOA& Gp, const TempSOA& Pm, const TempSOA& Pp,
+							  const TempSOA& am0, const TempSOA& ap0, const TempSOA& am1, const TempSOA& ap1,
+							  OutputSOA& divu, OutputSOA& sumG, OutputSOA& sumP) const
+{
+	for(int iy=0; iy<OutputSOA::NY; iy++)
+		for(int ix=0; ix<OutputSOA::NX; ix+=AVXLANES)
+		{
+			const vecreal m0 = _avx_mixedterm(am0.ptr(ix, iy), ap0.ptr(ix, iy), um0.ptr(ix, iy), up0.ptr(ix, iy));
+			const vecreal m1 = _avx_mixedterm(am1.ptr(ix, iy), ap1.ptr(ix, iy), um1.ptr(ix, iy), up1.ptr(ix, iy));
+
+			Real * const d = &divu.ref(ix, iy);
+			Real * const g = &sumG.ref(ix, iy);
+			Real * const p = &sumP.ref(ix, iy);
+
+			avx_store(d, avx_add(avx_load(d), avx_sub(m1, m0)));
+			avx_store(g, avx_add(avx_load(g), avx_add(avx_load(Gp.ptr(ix, iy)), avx_load(Gm.ptr(ix, iy)))));
+			avx_store(p, avx_add(avx_load(p), avx_add(avx_load(Pp.ptr(ix, iy)), avx_load(Pm.ptr(ix, iy)))));
+		}
+}
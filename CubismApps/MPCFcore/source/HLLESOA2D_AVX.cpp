@@ -0,0 +1,117 @@
+/*
+ *  HLLESOA2D_AVX.cpp
+ *  MPCFcore
+ *
+ */
+
+#include "HLLESOA2D_AVX.h"
+
+//fplus if aplus < 0, fminus if aminus > 0, the HLLE average otherwise
+inline vecreal _avx_hlle(const vecmask flagminus, const vecmask flagplus,
+						 const vecreal aminus, const vecreal aplus, const vecreal amul, const vecreal inv_adiff,
+						 const vecreal fminus, const vecreal fplus, const vecreal qminus, const vecreal qplus)
+{
+	const vecreal tmp = avx_madd(aplus, fminus, avx_nmsub(aminus, fplus, avx_mul(amul, avx_sub(qplus, qminus))));
+	const vecreal fother = avx_mul(tmp, inv_adiff);
+
+	return avx_sel(flagplus, avx_sel(flagminus, fother, fminus), fplus);
+}
+
+inline void _avx_hlle_all(const Real * const rm, const Real * const rp,
+						  const Real * const vdm, const Real * const vdp,
+						  const Real * const v1m, const Real * const v1p,
+						  const Real * const v2m, const Real * const v2p,
+						  const Real * const pm, const Real * const pp,
+						  const Real * const Gm, const Real * const Gp,
+						  const Real * const PIm, const Real * const PIp,
+						  Real * const outam, Real * const outap, Real * const outrho,
+						  Real * const outvd, Real * const outv1, Real * const outv2,
+						  Real * const oute, Real * const outG, Real * const outP)
+{
+	enum { NTOTAL = TempSOA::PITCH * TempSOA::NY };
+
+	const vecreal F_1_2 = avx_splat(0.5);
+	const vecreal F_1 = avx_splat(1);
+	const vecreal F_0 = avx_splat(0);
+
+	for(int ID = 0; ID < NTOTAL; ID += AVXLANES)
+	{
+		const vecreal rminus = avx_load(rm + ID);
+		const vecreal vdminus = avx_load(vdm + ID);
+		const vecreal v1minus = avx_load(v1m + ID);
+		const vecreal v2minus = avx_load(v2m + ID);
+		const vecreal pminus = avx_load(pm + ID);
+		const vecreal Gminus = avx_load(Gm + ID);
+		const vecreal PIminus = avx_load(PIm + ID);
+
+		const vecreal uminus = avx_mul(vdminus, rminus);
+		const vecreal uminus_v1 = avx_mul(v1minus, rminus);
+		const vecreal uminus_v2 = avx_mul(v2minus, rminus);
+		const vecreal speedminus = avx_madd(vdminus, vdminus, avx_madd(v1minus, v1minus, avx_mul(v2minus, v2minus)));
+		const vecreal eminus = avx_madd(pminus, Gminus, avx_madd(avx_mul(F_1_2, rminus), speedminus, PIminus));
+		const vecreal cminus = avx_sqrt(avx_div(avx_add(avx_div(avx_add(pminus, PIminus), Gminus), pminus), rminus));
+
+		const vecreal rplus = avx_load(rp + ID);
+		const vecreal vdplus = avx_load(vdp + ID);
+		const vecreal v1plus = avx_load(v1p + ID);
+		const vecreal v2plus = avx_load(v2p + ID);
+		const vecreal pplus = avx_load(pp + ID);
+		const vecreal Gplus = avx_load(Gp + ID);
+		const vecreal PIplus = avx_load(PIp + ID);
+
+		const vecreal uplus = avx_mul(vdplus, rplus);
+		const vecreal uplus_v1 = avx_mul(v1plus, rplus);
+		const vecreal uplus_v2 = avx_mul(v2plus, rplus);
+		const vecreal speedplus = avx_madd(vdplus, vdplus, avx_madd(v1plus, v1plus, avx_mul(v2plus, v2plus)));
+		const vecreal eplus = avx_madd(pplus, Gplus, avx_madd(avx_mul(F_1_2, rplus), speedplus, PIplus));
+		const vecreal cplus = avx_sqrt(avx_div(avx_add(avx_div(avx_add(pplus, PIplus), Gplus), pplus), rplus));
+
+		const vecreal aminus = avx_min(avx_sub(vdminus, cminus), avx_sub(vdplus, cplus));
+		const vecreal aplus = avx_max(avx_add(vdminus, cminus), avx_add(vdplus, cplus));
+		avx_store(outam + ID, aminus);
+		avx_store(outap + ID, aplus);
+
+		const vecmask flagminus = avx_cmpgt(aminus, F_0);
+		const vecmask flagplus = avx_cmplt(aplus, F_0);
+		const vecreal amul = avx_mul(aminus, aplus);
+		const vecreal inv_adiff = avx_div(F_1, avx_sub(aplus, aminus));
+
+		avx_store(outrho + ID, _avx_hlle(flagminus, flagplus, aminus, aplus, amul, inv_adiff,
+										 uminus, uplus, rminus, rplus));
+		avx_store(outvd + ID, _avx_hlle(flagminus, flagplus, aminus, aplus, amul, inv_adiff,
+										avx_madd(vdminus, uminus, pminus), avx_madd(vdplus, uplus, pplus), uminus, uplus));
+		avx_store(outv1 + ID, _avx_hlle(flagminus, flagplus, aminus, aplus, amul, inv_adiff,
+										avx_mul(vdminus, uminus_v1), avx_mul(vdplus, uplus_v1), uminus_v1, uplus_v1));
+		avx_store(outv2 + ID, _avx_hlle(flagminus, flagplus, aminus, aplus, amul, inv_adiff,
+										avx_mul(vdminus, uminus_v2), avx_mul(vdplus, uplus_v2), uminus_v2, uplus_v2));
+		avx_store(oute + ID, _avx_hlle(flagminus, flagplus, aminus, aplus, amul, inv_adiff,
+									   avx_mul(vdminus, avx_add(pminus, eminus)), avx_mul(vdplus, avx_add(pplus, eplus)), eminus, eplus));
+		avx_store(outG + ID, _avx_hlle(flagminus, flagplus, aminus, aplus, amul, inv_adiff,
+									   avx_mul(vdminus, Gminus), avx_mul(vdplus, Gplus), Gminus, Gplus));
+		avx_store(outP + ID, _avx_hlle(flagminus, flagplus, aminus, aplus, amul, inv_adiff,
+									   avx_mul(vdminus, PIminus), avx_mul(vdplus, PIplus), PIminus, PIplus));
+	}
+}
+
+void HLLESOA2D_AVX::all(const TempSOA& rminus, const TempSOA& rplus,
+						const TempSOA& vdminus, const TempSOA& vdplus,
+						const TempSOA& v1minus, const TempSOA& v1plus,
+						const TempSOA& v2minus, const TempSOA& v2plus,
+						const TempSOA& pminus, const TempSOA& pplus,
+						const TempSOA& Gminus, const TempSOA& Gplus,
+						const TempSOA& PIminus, const TempSOA& PIplus,
+						TempSOA& outam, TempSOA& outap, TempSOA& outrho,
+						TempSOA& outvd, TempSOA& outv1, TempSOA& outv2,
+						TempSOA& oute, TempSOA& outG, TempSOA& outP) const
+{
+	_avx_hlle_all(rminus.ptr(0,0), rplus.ptr(0,0),
+				  vdminus.ptr(0,0), vdplus.ptr(0,0),
+				  v1minus.ptr(0,0), v1plus.ptr(0,0),
+				  v2minus.ptr(0,0), v2plus.ptr(0,0),
+				  pminus.ptr(0,0), pplus.ptr(0,0),
+				  Gminus.ptr(0,0), Gplus.ptr(0,0),
+				  PIminus.ptr(0,0), PIplus.ptr(0,0),
+				  &outam.ref(0,0), &outap.ref(0,0), &outrho.ref(0,0),
+				  &outvd.ref(0,0), &outv1.ref(0,0), &outv2.ref(0,0),
+				  &oute.ref(0,0), &outG.ref(0,0), &outP.ref(0,0));
+}
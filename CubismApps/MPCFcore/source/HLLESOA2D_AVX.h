@@ -0,0 +1,26 @@
+/*
+ *  HLLESOA2D_AVX.h
+ *  MPCFcore
+ *
+ */
+
+#pragma once
+
+#include "common.h"
+#include "AVX.h"
+
+class HLLESOA2D_AVX
+{
+public:
+	//fused kernel: characteristic velocities and the seven HLLE fluxes
+	void all(const TempSOA& rminus, const TempSOA& rplus,
+			 const TempSOA& vdminus, const TempSOA& vdplus,
+			 const TempSOA& v1minus, const TempSOA& v1plus,
+			 const TempSOA& v2minus, const TempSOA& v2plus,
+			 const TempSOA& pminus, const TempSOA& pplus,
+			 const TempSOA& Gminus, const TempSOA& Gplus,
+			 const TempSOA& PIminus, const TempSOA& PIplus,
+			 TempSOA& outam, TempSOA& outap, TempSOA& outrho,
+			 TempSOA& outvd, TempSOA& outv1, TempSOA& outv2,
+			 TempSOA& oute,TempSOA& outG, TempSOA& outP) const;
+};
@@ -15,9 +15,9 @@
 #include "common.h"
 #include "MaxSpeedOfSound.h"
 
-Real MaxSpeedOfSound_CPP::compute(const Real * const src, const int gptfloats) const
+Real MaxSpeedOfSound_CPP::compute(const Real * const src, const int gptfloats, const int npoints) const
 {
-	const int N=_BLOCKSIZE_*_BLOCKSIZE_*_BLOCKSIZE_*gptfloats;
+	const int N=npoints*gptfloats;
 	Real sos = 0;
 	
 	for(int i=0; i<N; i+=gptfloats)
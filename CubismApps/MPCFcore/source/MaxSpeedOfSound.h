@@ -16,7 +16,8 @@
 class MaxSpeedOfSound_CPP
 {
 public:
-	Real compute(const Real * const src, const int gptfloats) const;
+	//the max characteristic speed of the first npoints grid points (by default the whole block)
+	Real compute(const Real * const src, const int gptfloats, const int npoints = _BLOCKSIZE_ * _BLOCKSIZE_ * _BLOCKSIZE_) const;
 	
 	static void printflops(const float PEAKPERF_CORE, const float PEAKBAND, const int NCORES, const int NT, const int NBLOCKS, float MEASUREDTIME, const bool bAwk=false)
 	{
@@ -0,0 +1,56 @@
+/*
+ *  MaxSpeedOfSound_AVX.h
+ *  MPCFcore
+ *
+ */
+
+#pragma once
+
+#include "MaxSpeedOfSound.h"
+#include "AVX.h"
+
+class MaxSpeedOfSound_AVX : public MaxSpeedOfSound_CPP
+{
+	enum
+	{
+		NPOINTS = _BLOCKSIZE_ * _BLOCKSIZE_ * _BLOCKSIZE_
+	};
+
+	inline vecreal _sweep(const Real * const src, const vecidx stride) const
+	{
+		const vecreal r = avx_gather(src, stride);
+		const vecreal u = avx_gather(src + 1, stride);
+		const vecreal v = avx_gather(src + 2, stride);
+		const vecreal w = avx_gather(src + 3, stride);
+		const vecreal e = avx_gather(src + 4, stride);
+		const vecreal G = avx_gather(src + 5, stride);
+		const vecreal P = avx_gather(src + 6, stride);
+
+		const vecreal invr = avx_div(avx_splat(1), r);
+		const vecreal speed2 = avx_madd(u, u, avx_madd(v, v, avx_mul(w, w)));
+		const vecreal maxvel = avx_max(avx_abs(u), avx_max(avx_abs(v), avx_abs(w)));
+
+		const vecreal p = avx_div(avx_madd(avx_mul(avx_splat(-0.5), invr), speed2, avx_sub(e, P)), G);
+		const vecreal c = avx_sqrt(avx_mul(avx_add(avx_div(avx_add(p, P), G), p), invr));
+
+		return avx_madd(maxvel, invr, c);
+	}
+
+public:
+
+	Real compute(const Real * const src, const int gptfloats, const int npoints = NPOINTS) const
+	{
+		assert(npoints % AVXLANES == 0);
+		assert(gptfloats >= 7);
+
+		const vecidx stride = avx_stride(gptfloats);
+		const int JUMP = AVXLANES * gptfloats;
+
+		vecreal sos = avx_splat(0);
+
+		for(int i=0; i < npoints * gptfloats; i += JUMP)
+			sos = avx_max(sos, _sweep(src + i, stride));
+
+		return avx_hmax(sos);
+	}
+};
@@ -80,9 +80,9 @@ class MaxSpeedOfSound_QPX : public MaxSpeedOfSound_CPP
 	
 public:
 	
-	template<int GPTFLOATS> Real _compute(Real * const src) const
+	template<int GPTFLOATS> Real _compute(Real * const src, const int npoints = NPOINTS) const
 	{
-		enum { NFLOATS = GPTFLOATS * NPOINTS };
+		const int NFLOATS = GPTFLOATS * npoints;
 		
 		vector4double sos4 = vec_splats(0);
 		
@@ -99,16 +99,17 @@ public:
 		return std::max(vec_extract(sos4, 0), vec_extract(sos4, 1));
 	}
 	
-	Real compute(const Real * const _src, const int gptfloats) const
+	Real compute(const Real * const _src, const int gptfloats, const int npoints = NPOINTS) const
 	{
 		assert(gptfloats == 8 || gptfloats == 16);
+		assert(npoints % 4 == 0);
 		
 		Real * const src = const_cast<Real *>(_src);	
 		
 		if (gptfloats == 8)
-			return _compute<8>(src);
+			return _compute<8>(src, npoints);
 		else if (gptfloats == 16)
-			return _compute<16>(src);
+			return _compute<16>(src, npoints);
 		else 
 		{
 			printf("ooops MaxSpeedOfSound_QPX::compute: gptfloats is not quite right. aborting.\n");
@@ -1,6 +1,6 @@
 /*
  *  QPXEMU.h
- *  
+ *
  *
  *  Created by Diego Rossinelli on 4/10/13.
  *  Copyright 2013 ETH Zurich. All rights reserved.
@@ -10,49 +10,64 @@
 #pragma once
 
 #ifdef _QPXEMU_
-#include <xmmintrin.h>
-#define vector4double __m128
-#define _DIEGO_TRANSPOSE4(a,b,c,d) _MM_TRANSPOSE4_PS(a,b,c,d)
-#define vec_lda(a, b) _mm_load_ps(b + ((a)/4))
-#define vec_sta(a, b, c) _mm_store_ps(c + ((b)/4), a)
-#define vec_mul(a, b) (a) * (b)
-#define vec_sub(a, b) (a) - (b)
-#define vec_add(a, b) (a) + (b)
-#define vec_madd(a, b, c) (a) * (b) + (c)
-#define vec_msub(a, b, c) (a) * (b) - (c)
-#define vec_nmsub(a, b, c) (c) - (a) * (b)
-#define vec_splats(a) _mm_set1_ps(a)
-#define vec_swdiv(a, b) _mm_div_ps(a, b)
-#define vec_res(a) _mm_rcp_ps(a)
-#define vec_re(a) _mm_rcp_ps(a)
-#define vec_rsqrtes(a) _mm_rsqrt_ps(a)
-#define vec_rsqrte(a) _mm_rsqrt_ps(a)
-#define vec_neg(a) _mm_setzero_ps() - (a)
+#include "SIMD.h"
+
+//the QPX intrinsics are emulated on top of SIMD<Real, 4>,
+//only the permutations and the transposition are ISA specific.
+//4 doubles need AVX2 (qpxemu=1 ap=double)
+#if !defined(_FLOAT_PRECISION_) && !defined(__AVX2__)
+#error QPX EMULATION IN DOUBLE PRECISION NEEDS AVX2
+#endif
+
+typedef SIMD<Real, 4> QPXSIMD;
+typedef QPXSIMD::type vector4double;
+
+#define _DIEGO_TRANSPOSE4(a,b,c,d) _qpxemu_transpose4(a,b,c,d)
 #define vec_gpci(a) a
 #define vec_perm(a,b,code) myshuffle<code>(a,b)
 #define vec_extract(a, b) my_extract<b>(a)
 
-static const unsigned int absvalmask1 = 0x7fffffff;
-const float * const absmaskptr = (float *)&absvalmask1;
-const __m128 absmask = _mm_set1_ps(*absmaskptr);
+inline vector4double vec_lda(const long a, const Real * const b) { return QPXSIMD::load(b + a / (long)sizeof(Real)); }
+inline void vec_sta(const vector4double a, const long b, Real * const c) { QPXSIMD::store(c + b / (long)sizeof(Real), a); }
+inline vector4double vec_mul(const vector4double a, const vector4double b) { return QPXSIMD::mul(a, b); }
+inline vector4double vec_sub(const vector4double a, const vector4double b) { return QPXSIMD::sub(a, b); }
+inline vector4double vec_add(const vector4double a, const vector4double b) { return QPXSIMD::add(a, b); }
+inline vector4double vec_madd(const vector4double a, const vector4double b, const vector4double c) { return QPXSIMD::madd(a, b, c); }
+inline vector4double vec_msub(const vector4double a, const vector4double b, const vector4double c) { return QPXSIMD::msub(a, b, c); }
+inline vector4double vec_nmsub(const vector4double a, const vector4double b, const vector4double c) { return QPXSIMD::nmsub(a, b, c); }
+inline vector4double vec_splats(const Real a) { return QPXSIMD::splat(a); }
+inline vector4double vec_swdiv(const vector4double a, const vector4double b) { return QPXSIMD::div(a, b); }
+inline vector4double vec_res(const vector4double a) { return QPXSIMD::rcp(a); }
+inline vector4double vec_re(const vector4double a) { return QPXSIMD::rcp(a); }
+inline vector4double vec_rsqrtes(const vector4double a) { return QPXSIMD::rsqrt(a); }
+inline vector4double vec_rsqrte(const vector4double a) { return QPXSIMD::rsqrt(a); }
+inline vector4double vec_neg(const vector4double a) { return QPXSIMD::sub(QPXSIMD::splat(0), a); }
+inline vector4double vec_abs(const vector4double a) { return QPXSIMD::abs(a); }
 
-inline __m128 vec_abs(__m128 a)
+//QPX select: b where c is non-negative, a otherwise
+inline vector4double vec_sel(const vector4double a, const vector4double b, const vector4double c)
 {
-	return _mm_and_ps(absmask, a);
+	return QPXSIMD::sel(QPXSIMD::cmpge(c, QPXSIMD::splat(0)), a, b);
 }
 
 template<int index>
-inline float my_extract(__m128 a)
+inline Real my_extract(vector4double a)
 {
-	float x[4];
-	
-	_mm_storeu_ps(x, a);
-	
+	Real x[4];
+
+	QPXSIMD::storeu(x, a);
+
 	return x[index];
 }
 
 template<int>
-inline __m128 myshuffle(__m128 a, __m128 b);
+inline vector4double myshuffle(vector4double a, vector4double b);
+
+#ifdef _FLOAT_PRECISION_
+inline void _qpxemu_transpose4(__m128& a, __m128& b, __m128& c, __m128& d)
+{
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+}
 
 template<>
 inline __m128 myshuffle<1114>(__m128 a, __m128 b)
@@ -83,14 +98,51 @@ inline __m128 myshuffle<03456>(__m128 a, __m128 b)
 {
 	return _mm_shuffle_ps(_mm_shuffle_ps(a,b, _MM_SHUFFLE(0,0,3,3)), b, _MM_SHUFFLE(2,1,3,0));
 }
+#else
+inline void _qpxemu_transpose4(__m256d& a, __m256d& b, __m256d& c, __m256d& d)
+{
+	const __m256d ab02 = _mm256_unpacklo_pd(a, b);
+	const __m256d ab13 = _mm256_unpackhi_pd(a, b);
+	const __m256d cd02 = _mm256_unpacklo_pd(c, d);
+	const __m256d cd13 = _mm256_unpackhi_pd(c, d);
+
+	a = _mm256_permute2f128_pd(ab02, cd02, 0x20);
+	b = _mm256_permute2f128_pd(ab13, cd13, 0x20);
+	c = _mm256_permute2f128_pd(ab02, cd02, 0x31);
+	d = _mm256_permute2f128_pd(ab13, cd13, 0x31);
+}
 
-inline __m128 vec_sel(const __m128 a, const __m128 b, const __m128 c)
+template<>
+inline __m256d myshuffle<1114>(__m256d a, __m256d b)
 {
-	const __m128 bwins = _mm_cmpge_ps(c, _mm_setzero_ps());
-	return _mm_or_ps(_mm_and_ps(bwins, b), _mm_andnot_ps(bwins, a));
+	return _mm256_blend_pd(_mm256_permute4x64_pd(a, _MM_SHUFFLE(1,1,1,1)), _mm256_permute4x64_pd(b, _MM_SHUFFLE(0,0,0,0)), 8);
 }
 
-#define __align(_ALIGNBYTES_) __attribute__((__aligned__(_ALIGNBYTES_)))
+template<>
+inline __m256d myshuffle<2323>(__m256d a, __m256d b)
+{
+	return _mm256_permute2f128_pd(a, a, 0x11);
+}
+
+template<>
+inline __m256d myshuffle<01234>(__m256d a, __m256d b)
+{
+	return _mm256_shuffle_pd(a, _mm256_permute2f128_pd(a, b, 0x21), 5);
+}
+
+template<>
+inline __m256d myshuffle<02345>(__m256d a, __m256d b)
+{
+	return _mm256_permute2f128_pd(a, b, 0x21);
+}
 
+template<>
+inline __m256d myshuffle<03456>(__m256d a, __m256d b)
+{
+	return _mm256_shuffle_pd(_mm256_permute2f128_pd(a, b, 0x21), b, 5);
+}
 #endif
 
+#define __align(_ALIGNBYTES_) __attribute__((__aligned__(_ALIGNBYTES_)))
+
+#endif
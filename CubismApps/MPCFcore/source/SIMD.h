@@ -0,0 +1,320 @@
+/*
+ *  SIMD.h
+ *  MPCFcore
+ *
+ */
+
+#pragma once
+
+#include <immintrin.h>
+#include <algorithm>
+
+//SIMD<T, LANES> wraps the x86 intrinsics for LANES values of type T.
+//available: SSE2 (4 floats, 2 doubles), AVX2 (8 floats, 4 doubles)
+//and AVX-512 (16 floats, 8 doubles), depending on the target of the compiler.
+//sel(m, a, b) picks b where the mask is set, rcp/rsqrt are approximations
+//whenever the ISA provides them.
+
+template<typename T, int LANES> struct SIMD;
+
+template<>
+struct SIMD<float, 4>
+{
+	typedef __m128 type;
+	typedef __m128 mask;
+	typedef __m128i index;
+	enum { LANES = 4, BYTES = 16 };
+
+	static type load(const float * const p) { return _mm_load_ps(p); }
+	static type loadu(const float * const p) { return _mm_loadu_ps(p); }
+	static void store(float * const p, const type a) { _mm_store_ps(p, a); }
+	static void storeu(float * const p, const type a) { _mm_storeu_ps(p, a); }
+	static type splat(const float a) { return _mm_set1_ps(a); }
+	static type add(const type a, const type b) { return _mm_add_ps(a, b); }
+	static type sub(const type a, const type b) { return _mm_sub_ps(a, b); }
+	static type mul(const type a, const type b) { return _mm_mul_ps(a, b); }
+	static type div(const type a, const type b) { return _mm_div_ps(a, b); }
+	static type madd(const type a, const type b, const type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static type msub(const type a, const type b, const type c) { return _mm_sub_ps(_mm_mul_ps(a, b), c); }
+	static type nmsub(const type a, const type b, const type c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+	static type min(const type a, const type b) { return _mm_min_ps(a, b); }
+	static type max(const type a, const type b) { return _mm_max_ps(a, b); }
+	static type sqrt(const type a) { return _mm_sqrt_ps(a); }
+	static type rcp(const type a) { return _mm_rcp_ps(a); }
+	static type rsqrt(const type a) { return _mm_rsqrt_ps(a); }
+	static type abs(const type a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+	static mask cmpgt(const type a, const type b) { return _mm_cmpgt_ps(a, b); }
+	static mask cmplt(const type a, const type b) { return _mm_cmplt_ps(a, b); }
+	static mask cmpge(const type a, const type b) { return _mm_cmpge_ps(a, b); }
+	static type sel(const mask m, const type a, const type b) { return _mm_or_ps(_mm_and_ps(m, b), _mm_andnot_ps(m, a)); }
+	static index stride(const int s) { return _mm_setr_epi32(0, s, 2 * s, 3 * s); }
+	static type gather(const float * const p, const index idx);
+	static void scatter(float * const p, const index idx, const type a);
+	static float hmax(const type a);
+};
+
+template<>
+struct SIMD<double, 2>
+{
+	typedef __m128d type;
+	typedef __m128d mask;
+	typedef __m128i index;
+	enum { LANES = 2, BYTES = 16 };
+
+	static type load(const double * const p) { return _mm_load_pd(p); }
+	static type loadu(const double * const p) { return _mm_loadu_pd(p); }
+	static void store(double * const p, const type a) { _mm_store_pd(p, a); }
+	static void storeu(double * const p, const type a) { _mm_storeu_pd(p, a); }
+	static type splat(const double a) { return _mm_set1_pd(a); }
+	static type add(const type a, const type b) { return _mm_add_pd(a, b); }
+	static type sub(const type a, const type b) { return _mm_sub_pd(a, b); }
+	static type mul(const type a, const type b) { return _mm_mul_pd(a, b); }
+	static type div(const type a, const type b) { return _mm_div_pd(a, b); }
+	static type madd(const type a, const type b, const type c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+	static type msub(const type a, const type b, const type c) { return _mm_sub_pd(_mm_mul_pd(a, b), c); }
+	static type nmsub(const type a, const type b, const type c) { return _mm_sub_pd(c, _mm_mul_pd(a, b)); }
+	static type min(const type a, const type b) { return _mm_min_pd(a, b); }
+	static type max(const type a, const type b) { return _mm_max_pd(a, b); }
+	static type sqrt(const type a) { return _mm_sqrt_pd(a); }
+	static type rcp(const type a) { return _mm_div_pd(_mm_set1_pd(1), a); }
+	static type rsqrt(const type a) { return _mm_div_pd(_mm_set1_pd(1), _mm_sqrt_pd(a)); }
+	static type abs(const type a) { return _mm_andnot_pd(_mm_set1_pd(-0.), a); }
+	static mask cmpgt(const type a, const type b) { return _mm_cmpgt_pd(a, b); }
+	static mask cmplt(const type a, const type b) { return _mm_cmplt_pd(a, b); }
+	static mask cmpge(const type a, const type b) { return _mm_cmpge_pd(a, b); }
+	static type sel(const mask m, const type a, const type b) { return _mm_or_pd(_mm_and_pd(m, b), _mm_andnot_pd(m, a)); }
+	static index stride(const int s) { return _mm_setr_epi32(0, s, 0, 0); }
+	static type gather(const double * const p, const index idx);
+	static void scatter(double * const p, const index idx, const type a);
+	static double hmax(const type a);
+};
+
+#ifdef __AVX2__
+
+#ifdef __FMA__
+#define _SIMD_FMADD256(ps, a, b, c) _mm256_fmadd_##ps(a, b, c)
+#define _SIMD_FMSUB256(ps, a, b, c) _mm256_fmsub_##ps(a, b, c)
+#define _SIMD_FNMADD256(ps, a, b, c) _mm256_fnmadd_##ps(a, b, c)
+#else
+#define _SIMD_FMADD256(ps, a, b, c) _mm256_add_##ps(_mm256_mul_##ps(a, b), c)
+#define _SIMD_FMSUB256(ps, a, b, c) _mm256_sub_##ps(_mm256_mul_##ps(a, b), c)
+#define _SIMD_FNMADD256(ps, a, b, c) _mm256_sub_##ps(c, _mm256_mul_##ps(a, b))
+#endif
+
+template<>
+struct SIMD<float, 8>
+{
+	typedef __m256 type;
+	typedef __m256 mask;
+	typedef __m256i index;
+	enum { LANES = 8, BYTES = 32 };
+
+	static type load(const float * const p) { return _mm256_load_ps(p); }
+	static type loadu(const float * const p) { return _mm256_loadu_ps(p); }
+	static void store(float * const p, const type a) { _mm256_store_ps(p, a); }
+	static void storeu(float * const p, const type a) { _mm256_storeu_ps(p, a); }
+	static type splat(const float a) { return _mm256_set1_ps(a); }
+	static type add(const type a, const type b) { return _mm256_add_ps(a, b); }
+	static type sub(const type a, const type b) { return _mm256_sub_ps(a, b); }
+	static type mul(const type a, const type b) { return _mm256_mul_ps(a, b); }
+	static type div(const type a, const type b) { return _mm256_div_ps(a, b); }
+	static type madd(const type a, const type b, const type c) { return _SIMD_FMADD256(ps, a, b, c); }
+	static type msub(const type a, const type b, const type c) { return _SIMD_FMSUB256(ps, a, b, c); }
+	static type nmsub(const type a, const type b, const type c) { return _SIMD_FNMADD256(ps, a, b, c); }
+	static type min(const type a, const type b) { return _mm256_min_ps(a, b); }
+	static type max(const type a, const type b) { return _mm256_max_ps(a, b); }
+	static type sqrt(const type a) { return _mm256_sqrt_ps(a); }
+	static type rcp(const type a) { return _mm256_rcp_ps(a); }
+	static type rsqrt(const type a) { return _mm256_rsqrt_ps(a); }
+	static type abs(const type a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+	static mask cmpgt(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static mask cmplt(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static mask cmpge(const type a, const type b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static type sel(const mask m, const type a, const type b) { return _mm256_blendv_ps(a, b, m); }
+	static index stride(const int s) { return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(s)); }
+	static type gather(const float * const p, const index idx) { return _mm256_i32gather_ps(p, idx, sizeof(float)); }
+	static void scatter(float * const p, const index idx, const type a);
+	static float hmax(const type a);
+};
+
+template<>
+struct SIMD<double, 4>
+{
+	typedef __m256d type;
+	typedef __m256d mask;
+	typedef __m128i index;
+	enum { LANES = 4, BYTES = 32 };
+
+	static type load(const double * const p) { return _mm256_load_pd(p); }
+	static type loadu(const double * const p) { return _mm256_loadu_pd(p); }
+	static void store(double * const p, const type a) { _mm256_store_pd(p, a); }
+	static void storeu(double * const p, const type a) { _mm256_storeu_pd(p, a); }
+	static type splat(const double a) { return _mm256_set1_pd(a); }
+	static type add(const type a, const type b) { return _mm256_add_pd(a, b); }
+	static type sub(const type a, const type b) { return _mm256_sub_pd(a, b); }
+	static type mul(const type a, const type b) { return _mm256_mul_pd(a, b); }
+	static type div(const type a, const type b) { return _mm256_div_pd(a, b); }
+	static type madd(const type a, const type b, const type c) { return _SIMD_FMADD256(pd, a, b, c); }
+	static type msub(const type a, const type b, const type c) { return _SIMD_FMSUB256(pd, a, b, c); }
+	static type nmsub(const type a, const type b, const type c) { return _SIMD_FNMADD256(pd, a, b, c); }
+	static type min(const type a, const type b) { return _mm256_min_pd(a, b); }
+	static type max(const type a, const type b) { return _mm256_max_pd(a, b); }
+	static type sqrt(const type a) { return _mm256_sqrt_pd(a); }
+	static type rcp(const type a) { return _mm256_div_pd(_mm256_set1_pd(1), a); }
+	static type rsqrt(const type a) { return _mm256_div_pd(_mm256_set1_pd(1), _mm256_sqrt_pd(a)); }
+	static type abs(const type a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.), a); }
+	static mask cmpgt(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+	static mask cmplt(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+	static mask cmpge(const type a, const type b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+	static type sel(const mask m, const type a, const type b) { return _mm256_blendv_pd(a, b, m); }
+	static index stride(const int s) { return _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(s)); }
+	static type gather(const double * const p, const index idx) { return _mm256_i32gather_pd(p, idx, sizeof(double)); }
+	static void scatter(double * const p, const index idx, const type a);
+	static double hmax(const type a);
+};
+
+#undef _SIMD_FMADD256
+#undef _SIMD_FMSUB256
+#undef _SIMD_FNMADD256
+
+#endif
+
+#ifdef __AVX512F__
+
+template<>
+struct SIMD<float, 16>
+{
+	typedef __m512 type;
+	typedef __mmask16 mask;
+	typedef __m512i index;
+	enum { LANES = 16, BYTES = 64 };
+
+	static type load(const float * const p) { return _mm512_load_ps(p); }
+	static type loadu(const float * const p) { return _mm512_loadu_ps(p); }
+	static void store(float * const p, const type a) { _mm512_store_ps(p, a); }
+	static void storeu(float * const p, const type a) { _mm512_storeu_ps(p, a); }
+	static type splat(const float a) { return _mm512_set1_ps(a); }
+	static type add(const type a, const type b) { return _mm512_add_ps(a, b); }
+	static type sub(const type a, const type b) { return _mm512_sub_ps(a, b); }
+	static type mul(const type a, const type b) { return _mm512_mul_ps(a, b); }
+	static type div(const type a, const type b) { return _mm512_div_ps(a, b); }
+	static type madd(const type a, const type b, const type c) { return _mm512_fmadd_ps(a, b, c); }
+	static type msub(const type a, const type b, const type c) { return _mm512_fmsub_ps(a, b, c); }
+	static type nmsub(const type a, const type b, const type c) { return _mm512_fnmadd_ps(a, b, c); }
+	static type min(const type a, const type b) { return _mm512_min_ps(a, b); }
+	static type max(const type a, const type b) { return _mm512_max_ps(a, b); }
+	static type sqrt(const type a) { return _mm512_sqrt_ps(a); }
+	static type rcp(const type a) { return _mm512_rcp14_ps(a); }
+	static type rsqrt(const type a) { return _mm512_rsqrt14_ps(a); }
+	static type abs(const type a) { return _mm512_abs_ps(a); }
+	static mask cmpgt(const type a, const type b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+	static mask cmplt(const type a, const type b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+	static mask cmpge(const type a, const type b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+	static type sel(const mask m, const type a, const type b) { return _mm512_mask_blend_ps(m, a, b); }
+	static index stride(const int s) { return _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(s)); }
+	static type gather(const float * const p, const index idx) { return _mm512_i32gather_ps(idx, p, sizeof(float)); }
+	static void scatter(float * const p, const index idx, const type a) { _mm512_i32scatter_ps(p, idx, a, sizeof(float)); }
+	static float hmax(const type a) { return _mm512_reduce_max_ps(a); }
+};
+
+template<>
+struct SIMD<double, 8>
+{
+	typedef __m512d type;
+	typedef __mmask8 mask;
+	typedef __m256i index;
+	enum { LANES = 8, BYTES = 64 };
+
+	static type load(const double * const p) { return _mm512_load_pd(p); }
+	static type loadu(const double * const p) { return _mm512_loadu_pd(p); }
+	static void store(double * const p, const type a) { _mm512_store_pd(p, a); }
+	static void storeu(double * const p, const type a) { _mm512_storeu_pd(p, a); }
+	static type splat(const double a) { return _mm512_set1_pd(a); }
+	static type add(const type a, const type b) { return _mm512_add_pd(a, b); }
+	static type sub(const type a, const type b) { return _mm512_sub_pd(a, b); }
+	static type mul(const type a, const type b) { return _mm512_mul_pd(a, b); }
+	static type div(const type a, const type b) { return _mm512_div_pd(a, b); }
+	static type madd(const type a, const type b, const type c) { return _mm512_fmadd_pd(a, b, c); }
+	static type msub(const type a, const type b, const type c) { return _mm512_fmsub_pd(a, b, c); }
+	static type nmsub(const type a, const type b, const type c) { return _mm512_fnmadd_pd(a, b, c); }
+	static type min(const type a, const type b) { return _mm512_min_pd(a, b); }
+	static type max(const type a, const type b) { return _mm512_max_pd(a, b); }
+	static type sqrt(const type a) { return _mm512_sqrt_pd(a); }
+	static type rcp(const type a) { return _mm512_rcp14_pd(a); }
+	static type rsqrt(const type a) { return _mm512_rsqrt14_pd(a); }
+	static type abs(const type a) { return _mm512_abs_pd(a); }
+	static mask cmpgt(const type a, const type b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+	static mask cmplt(const type a, const type b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+	static mask cmpge(const type a, const type b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+	static type sel(const mask m, const type a, const type b) { return _mm512_mask_blend_pd(m, a, b); }
+	static index stride(const int s) { return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(s)); }
+	static type gather(const double * const p, const index idx) { return _mm512_i32gather_pd(idx, p, sizeof(double)); }
+	static void scatter(double * const p, const index idx, const type a) { _mm512_i32scatter_pd(p, idx, a, sizeof(double)); }
+	static double hmax(const type a) { return _mm512_reduce_max_pd(a); }
+};
+
+#endif
+
+//generic fallbacks: these go through the stack
+template<typename T, int LANES>
+struct _SIMDScalar
+{
+	typedef SIMD<T, LANES> S;
+	enum { NIDX = LANES < 4 ? 4 : LANES };
+
+	static void idx(int * const p, const __m128i i) { _mm_storeu_si128((__m128i *)p, i); }
+#ifdef __AVX2__
+	static void idx(int * const p, const __m256i i) { _mm256_storeu_si256((__m256i *)p, i); }
+#endif
+
+	static typename S::type gather(const T * const p, const typename S::index i)
+	{
+		T __attribute__((__aligned__(S::BYTES))) tmp[LANES];
+		int id[NIDX];
+		idx(id, i);
+
+		for(int l = 0; l < LANES; ++l)
+			tmp[l] = p[id[l]];
+
+		return S::load(tmp);
+	}
+
+	static void scatter(T * const p, const typename S::index i, const typename S::type a)
+	{
+		T __attribute__((__aligned__(S::BYTES))) tmp[LANES];
+		int id[NIDX];
+		S::store(tmp, a);
+		idx(id, i);
+
+		for(int l = 0; l < LANES; ++l)
+			p[id[l]] = tmp[l];
+	}
+
+	static T hmax(const typename S::type a)
+	{
+		T __attribute__((__aligned__(S::BYTES))) tmp[LANES];
+		S::store(tmp, a);
+
+		T result = tmp[0];
+		for(int l = 1; l < LANES; ++l)
+			result = std::max(result, tmp[l]);
+
+		return result;
+	}
+};
+
+inline SIMD<float, 4>::type SIMD<float, 4>::gather(const float * const p, const index idx) { return _SIMDScalar<float, 4>::gather(p, idx); }
+inline void SIMD<float, 4>::scatter(float * const p, const index idx, const type a) { _SIMDScalar<float, 4>::scatter(p, idx, a); }
+inline float SIMD<float, 4>::hmax(const type a) { return _SIMDScalar<float, 4>::hmax(a); }
+
+inline SIMD<double, 2>::type SIMD<double, 2>::gather(const double * const p, const index idx) { return _SIMDScalar<double, 2>::gather(p, idx); }
+inline void SIMD<double, 2>::scatter(double * const p, const index idx, const type a) { _SIMDScalar<double, 2>::scatter(p, idx, a); }
+inline double SIMD<double, 2>::hmax(const type a) { return _SIMDScalar<double, 2>::hmax(a); }
+
+#ifdef __AVX2__
+inline void SIMD<float, 8>::scatter(float * const p, const index idx, const type a) { _SIMDScalar<float, 8>::scatter(p, idx, a); }
+inline float SIMD<float, 8>::hmax(const type a) { return _SIMDScalar<float, 8>::hmax(a); }
+
+inline void SIMD<double, 4>::scatter(double * const p, const index idx, const type a) { _SIMDScalar<double, 4>::scatter(p, idx, a); }
+inline double SIMD<double, 4>::hmax(const type a) { return _SIMDScalar<double, 4>::hmax(a); }
+#endif
@@ -104,4 +104,58 @@ struct RingSOA2D
 	}
 };
 
+//same as RingSOA2D, but a slot can be bound to a slice owned by someone else (e.g. a SoA lab).
+//ref() gives back the own slice of the slot, hence writing never goes to a bound slice
+template< int _SX, int _EX, int _SY, int _EY, int _NSLICES, typename TReal=Real>
+struct RingViewSOA2D
+{
+	typedef SOA2D<_SX, _EX, _SY, _EY, TReal> TSlice;
+	
+	int currslice;
+	
+	TSlice slices[_NSLICES];
+	const TSlice * views[_NSLICES];
+	
+	RingViewSOA2D(): currslice(0)
+	{
+		for(int i=0; i<_NSLICES; ++i)
+			views[i] = slices + i;
+	}
+	
+	RingViewSOA2D(const RingViewSOA2D& c): currslice(c.currslice)
+	{
+		for(int i=0; i<_NSLICES; ++i)
+		{
+			slices[i] = c.slices[i];
+			views[i] = slices + i;
+		}
+	}
+	
+	inline const TSlice& operator()(const int relativeid=0) const
+	{
+		return *views[(relativeid + currslice + _NSLICES) % _NSLICES];
+	}
+	
+	inline TSlice& ref(const int relativeid=0)
+	{
+		const int id = (relativeid + currslice + _NSLICES) % _NSLICES;
+		
+		views[id] = slices + id;
+		
+		return slices[id];
+	}
+	
+	inline void bind(const TSlice& slice, const int relativeid=0)
+	{
+		views[(relativeid + currslice + _NSLICES) % _NSLICES] = &slice;
+	}
+	
+	void next(){ currslice = (currslice + 1) % _NSLICES; } 
+	
+	static float kB(int nobjects=1)
+	{
+		return nobjects*sizeof(RingViewSOA2D)/1024.;
+	}
+};
+
 typedef SOA2D<0, _BLOCKSIZE_, 0, _BLOCKSIZE_> OutputSOA;
@@ -44,7 +44,7 @@ struct MatrixGP
 	static const int LZ = _LZ;
 	
 	//char screwup_alignment;
-	GP __attribute__((__aligned__(16))) data[_LZ][_LY][_LX];
+	GP __attribute__((__aligned__(_ALIGNBYTES_))) data[_LZ][_LY][_LX];
 	
 	
 	inline GP& operator()(const int ix, const int iy, const int iz)
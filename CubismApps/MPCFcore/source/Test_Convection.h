@@ -13,6 +13,8 @@
 #include <iostream>
 #include <iomanip>
 #include <typeinfo>
+#include <limits>
+#include <vector>
 
 #include <Timer.h>
 
@@ -49,7 +51,7 @@ public:
 
 
 	template<typename TCOV>
-	inline void _apply_kernel(TCOV &kernel, TestLab& lab, Block& block)
+	inline void _apply_kernel(TCOV &kernel, TestLab& lab, Block& block, const bool zstream=false)
 	{
 		const Real * const srcfirst = &(lab)(-3,-3, -3).s.r;
 		const int srcfloats  = sizeof(GP)/sizeof(Real);
@@ -61,9 +63,178 @@ public:
 		const int rowdsts =  _BLOCKSIZE_;
 		const int slicedsts = _BLOCKSIZE_*_BLOCKSIZE_;
 
-		kernel.compute(srcfirst, srcfloats, rowsrcs, slicesrcs, dstfirst, dstfloats, rowdsts, slicedsts);
+		if (zstream)
+			kernel.compute_zstream(srcfirst, srcfloats, rowsrcs, slicesrcs, dstfirst, dstfloats, rowdsts, slicedsts);
+		else
+			kernel.compute(srcfirst, srcfloats, rowsrcs, slicesrcs, dstfirst, dstfloats, rowdsts, slicedsts);
+	}
+
+	//the z-neighbor streamed through compute_zstream(.) has to match compute(.) on the same lab
+	template<typename TCOV>
+	void _accuracy_zstream(TCOV& kernel, double accuracy)
+	{
+		TestLab * lab = new TestLab;
+		TestLab * labnext = new TestLab;
+		Block * blockgold = new Block;
+		Block * block = new Block;
+
+		_initialize_lab(*lab);
+		_initialize_block(*blockgold);
+		_initialize_block(*block);
+
+		//slices -3..2 of labnext are the top slices of lab, except for their x- and y-ghosts
+		for(int iz = -3; iz<_BLOCKSIZE_+3; iz++)
+			for(int iy = -3; iy<_BLOCKSIZE_+3; iy++)
+				for(int ix = -3; ix<_BLOCKSIZE_+3; ix++)
+				{
+					const bool ghost = ix < 0 || ix >= _BLOCKSIZE_ || iy < 0 || iy >= _BLOCKSIZE_;
+
+					(*labnext)(ix, iy, iz) = iz < 3 ? (*lab)(ix, iy, iz + _BLOCKSIZE_) : (*lab)(ix, iy, _BLOCKSIZE_ + 5 - iz);
+
+					if (iz < 3 && ghost)
+						(*labnext)(ix, iy, iz).s.r *= 1.1;
+				}
+
+		_apply_kernel(kernel, *labnext, *blockgold);
+
+		//the lower z-ghosts must not be accessed when streaming
+		for(int iz = -3; iz<0; iz++)
+			for(int iy = -3; iy<_BLOCKSIZE_+3; iy++)
+				for(int ix = -3; ix<_BLOCKSIZE_+3; ix++)
+					(*labnext)(ix, iy, iz).s.r = numeric_limits<Real>::quiet_NaN();
+
+		_apply_kernel(kernel, *lab, *block);
+		_apply_kernel(kernel, *labnext, *block, true);
+
+		{
+			Real * const data= &(*block)(0,0,0).dsdt.r;
+			Real * const gold_data= &(*blockgold)(0,0,0).dsdt.r;
+
+			const int srcfloats  = sizeof(GP)/sizeof(Real);
+			for (int i = 0; i < _BLOCKSIZE_*_BLOCKSIZE_*_BLOCKSIZE_*srcfloats; i += srcfloats)
+				check_error(accuracy, &data[i], &gold_data[i], 7);
+		}
+
+		delete block;
+		delete blockgold;
+		delete labnext;
+		delete lab;
+	}
+
+	//compute(.) reading the slices of a SoA lab has to match compute(.) on the AoS lab
+	template<typename TCOV>
+	void _accuracy_soa(TCOV& kernel, double accuracy)
+	{
+		TestLab * lab = new TestLab;
+		Block * blockgold = new Block;
+		Block * block = new Block;
+
+		InputSOASlice * soalab = NULL;
+		const int error = posix_memalign((void **)&soalab, _ALIGNBYTES_, sizeof(InputSOASlice) * (_BLOCKSIZE_+6));
+		assert(error == 0);
+
+		_initialize_lab(*lab);
+		_initialize_block(*blockgold);
+		_initialize_block(*block);
+
+		for(int iz = -3; iz<_BLOCKSIZE_+3; iz++)
+			for(int iy = -3; iy<_BLOCKSIZE_+3; iy++)
+				for(int ix = -3; ix<_BLOCKSIZE_+3; ix++)
+				{
+					const StateVector pt = (*lab)(ix, iy, iz).s;
+					InputSOASlice& slice = soalab[iz + 3];
+
+					slice.rho.ref(ix, iy) = pt.r;
+					slice.u.ref(ix, iy) = pt.u/pt.r;
+					slice.v.ref(ix, iy) = pt.v/pt.r;
+					slice.w.ref(ix, iy) = pt.w/pt.r;
+					slice.p.ref(ix, iy) = (pt.s - ( (pt.u*pt.u + pt.v*pt.v + pt.w*pt.w)*(((Real)0.5)/pt.r)+pt.P ))/pt.G;
+					slice.G.ref(ix, iy) = pt.G;
+					slice.P.ref(ix, iy) = pt.P;
+				}
+
+		_apply_kernel(kernel, *lab, *blockgold);
+
+		kernel.compute(soalab, &(*block)(0,0,0).dsdt.r, sizeof(GP)/sizeof(Real), _BLOCKSIZE_, _BLOCKSIZE_*_BLOCKSIZE_);
+
+		{
+			Real * const data= &(*block)(0,0,0).dsdt.r;
+			Real * const gold_data= &(*blockgold)(0,0,0).dsdt.r;
+
+			const int srcfloats  = sizeof(GP)/sizeof(Real);
+			for (int i = 0; i < _BLOCKSIZE_*_BLOCKSIZE_*_BLOCKSIZE_*srcfloats; i += srcfloats)
+				check_error(accuracy, &data[i], &gold_data[i], 7);
+		}
+
+		free(soalab);
+		delete block;
+		delete blockgold;
+		delete lab;
 	}
 
+	//compute(.) reading the block and its ghosts in place has to match compute(.) on the AoS lab:
+	//each region of the lab is copied into its own AoS array, gptfloats being that of StateVector
+	template<typename TCOV>
+	void _accuracy_halo(TCOV& kernel, double accuracy)
+	{
+		TestLab * lab = new TestLab;
+		Block * blockgold = new Block;
+		Block * block = new Block;
+
+		_initialize_lab(*lab);
+		_initialize_block(*blockgold);
+		_initialize_block(*block);
+
+		const int gptfloats = sizeof(StateVector)/sizeof(Real);
+
+		vector<Real> regions[27];
+		HaloSource src;
+		src.gptfloats = gptfloats;
+
+		for(int i=0; i<27; i++)
+		{
+			const int code[3] = { i%3 - 1, (i/3)%3 - 1, i/9 - 1 };
+
+			int s[3], n[3];
+			for(int d=0; d<3; d++)
+			{
+				s[d] = code[d] < 0 ? -3 : code[d] * _BLOCKSIZE_;
+				n[d] = code[d] == 0 ? _BLOCKSIZE_ : 3;
+			}
+
+			regions[i].resize(n[0] * n[1] * n[2] * gptfloats);
+
+			for(int iz=0; iz<n[2]; iz++)
+				for(int iy=0; iy<n[1]; iy++)
+					for(int ix=0; ix<n[0]; ix++)
+					{
+						const Real * const pt = &(*lab)(s[0] + ix, s[1] + iy, s[2] + iz).s.r;
+
+						for(int c=0; c<gptfloats; c++)
+							regions[i][gptfloats * (ix + n[0] * (iy + n[1] * iz)) + c] = pt[c];
+					}
+
+			const HaloRegion r = { &regions[i].front(), n[0], n[0] * n[1] };
+			src.region[i] = r;
+		}
+
+		_apply_kernel(kernel, *lab, *blockgold);
+
+		kernel.compute(src, &(*block)(0,0,0).dsdt.r, sizeof(GP)/sizeof(Real), _BLOCKSIZE_, _BLOCKSIZE_*_BLOCKSIZE_);
+
+		{
+			Real * const data= &(*block)(0,0,0).dsdt.r;
+			Real * const gold_data= &(*blockgold)(0,0,0).dsdt.r;
+
+			const int srcfloats  = sizeof(GP)/sizeof(Real);
+			for (int i = 0; i < _BLOCKSIZE_*_BLOCKSIZE_*_BLOCKSIZE_*srcfloats; i += srcfloats)
+				check_error(accuracy, &data[i], &gold_data[i], 7);
+		}
+
+		delete block;
+		delete blockgold;
+		delete lab;
+	}
 
 	template<typename TCOV>
 	void accuracy(TCOV& kernel, double accuracy=1e-4, bool bAwk=false)
@@ -138,6 +309,10 @@ public:
 
 		}
 
+		_accuracy_zstream(kernel, accuracy);
+		_accuracy_soa(kernel, accuracy);
+		_accuracy_halo(kernel, accuracy);
+
 		printEndLine();		
 
 		delete block;    
@@ -146,7 +321,7 @@ public:
         }
 	
 protected:
-	template<typename FS> double _benchmark(FS fs, const int NBLOCKS, const int NTIMES)
+	template<typename FS> double _benchmark(FS& fs, const int NBLOCKS, const int NTIMES)
 	{
 		TestLab * lab = new TestLab[NBLOCKS];
 		Block * block = new Block[NBLOCKS];
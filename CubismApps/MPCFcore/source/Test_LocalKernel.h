@@ -132,6 +132,39 @@ class Test_LocalKernel
 				delete blockgold;
 			}
 
+		//compute_maxsos(.) against compute(.) followed by the SOS kernel of the same family
+		template<typename TUPDATE>
+			void accuracy_maxsos(TUPDATE& kernel, double accuracy=1e-4)
+			{
+				Block * blockgold = new Block;
+				Block * block = new Block;
+
+				_initialize(*blockgold);
+				_initialize(*block);
+
+				const int srcfloats  = sizeof(GP)/sizeof(Real);
+
+				kernel.compute(&(*blockgold)(0,0,0).dsdt.r, &(*blockgold)(0,0,0).s.r, srcfloats);
+				const Real v1 = typename TUPDATE::SOSKernel().compute(&(*blockgold)(0,0,0).s.r, srcfloats);
+
+				//run Kernel
+				const Real v2 = kernel.compute_maxsos(&(*block)(0,0,0).dsdt.r, &(*block)(0,0,0).s.r, srcfloats);
+
+				printAccuracyTitle();
+				printf("\tMAXSOS: %e (reference) %e (tested kernel)\n", v1, v2);
+
+				check_error(accuracy, &v2, &v1, 1);
+
+				Real * const data= &(*block)(0,0,0).s.r;
+				Real * const gold_data= &(*blockgold)(0,0,0).s.r;
+
+				for (int i = 0; i < _BLOCKSIZE_*_BLOCKSIZE_*_BLOCKSIZE_*srcfloats; i += srcfloats)
+					check_error(accuracy, &data[i], &gold_data[i], 7);
+
+				delete block;
+				delete blockgold;
+			}
+
 		template<typename TKernel> double _benchmarkSOS(TKernel kernel, const int NBLOCKS, const int NTIMES)
 		{
 			Block * block = new Block[NBLOCKS];
@@ -11,6 +11,7 @@
 #include <iostream>
 #include <cstdlib>
 #include <limits>
+#include <algorithm>
 
 #include "common.h"
 #include "Update.h"
@@ -40,3 +41,24 @@ void Update_CPP::compute(const Real * const src, Real * const dst, const int gpt
         //assert(dst[i+4]>0);
     }
 }
+
+Real Update_CPP::compute_maxsos(const Real * const src, Real * const dst, const int gptfloats) const
+{
+	assert(gptfloats >= 7);
+	
+	const SOSKernel sos;
+	const int SLICEPOINTS = _BLOCKSIZE_ * _BLOCKSIZE_;
+	const int SLICEFLOATS = SLICEPOINTS * gptfloats;
+	
+	Real retval = 0;
+	
+	for(int s=0; s<_BLOCKSIZE_ * SLICEFLOATS; s+=SLICEFLOATS)
+	{
+		for(int i=s; i<s+SLICEFLOATS; i++)
+			dst[i] += m_b * src[i];
+		
+		retval = max(retval, sos.compute(dst + s, gptfloats, SLICEPOINTS));
+	}
+	
+	return retval;
+}
@@ -12,6 +12,7 @@
 #include <cstdio>
 
 #include "common.h"
+#include "MaxSpeedOfSound.h"
 
 class Update_CPP
 {
@@ -26,10 +27,17 @@ protected:
 	
 public:
 	
+	//the speed of sound kernel of the same family, used by compute_maxsos(.)
+	typedef MaxSpeedOfSound_CPP SOSKernel;
+	
 	Update_CPP(Real b=1): m_b(b) {}
 	
 	void compute(const Real * const src, Real * const dst, const int gptfloats) const;
 	
+	//same as compute(.), it also returns the max characteristic speed of the updated points.
+	//the block is updated slice by slice, SOSKernel scanning each slice while it is in cache
+	Real compute_maxsos(const Real * const src, Real * const dst, const int gptfloats) const;
+	
 	static void printflops(const float PEAKPERF_CORE, const float PEAKBAND, const size_t NCORES, const size_t NT, const size_t NBLOCKS, const float MEASUREDTIME, const bool bAwk=false)
 	{
 		const float PEAKPERF = PEAKPERF_CORE*NCORES;
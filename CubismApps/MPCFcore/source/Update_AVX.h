@@ -0,0 +1,76 @@
+/*
+ *  Update_AVX.h
+ *  MPCFcore
+ *
+ */
+
+#pragma once
+
+#include "Update.h"
+#include "MaxSpeedOfSound_AVX.h"
+#include "AVX.h"
+
+struct Update_AVX : public Update_CPP
+{
+	enum {
+		NPOINTS = _BLOCKSIZE_ * _BLOCKSIZE_ * _BLOCKSIZE_,
+		SLICEPOINTS = _BLOCKSIZE_ * _BLOCKSIZE_
+	};
+
+public:
+
+	typedef MaxSpeedOfSound_AVX SOSKernel;
+
+	Update_AVX(const Real b = 1): Update_CPP(b) {}
+
+	template<int NFLOATS>
+	void _compute(const vecreal myb, const Real * const src, Real * const dst) const
+	{
+		for(int i = 0; i < NFLOATS; i += 2 * AVXLANES)
+		{
+			avx_storeu(dst + i, avx_madd(myb, avx_loadu(src + i), avx_loadu(dst + i)));
+			avx_storeu(dst + i + AVXLANES, avx_madd(myb, avx_loadu(src + i + AVXLANES), avx_loadu(dst + i + AVXLANES)));
+		}
+	}
+
+	void compute(const Real * const src, Real * const dst, const int gptfloats) const
+	{
+		assert(gptfloats == 8 || gptfloats == 16);
+
+		const vecreal myb = avx_splat(m_b);
+
+		if (gptfloats == 8)
+			_compute<NPOINTS * 8>(myb, src, dst);
+		else if (gptfloats == 16)
+			_compute<NPOINTS * 16>(myb, src, dst);
+		else
+		{
+			printf("ooops Update_AVX::compute: gptfloats is not quite right. aborting.\n");
+			abort();
+		}
+	}
+
+	//see Update_CPP::compute_maxsos
+	Real compute_maxsos(const Real * const src, Real * const dst, const int gptfloats) const
+	{
+		assert(gptfloats == 8 || gptfloats == 16);
+
+		const SOSKernel sos;
+		const vecreal myb = avx_splat(m_b);
+		const int SLICEFLOATS = SLICEPOINTS * gptfloats;
+
+		Real retval = 0;
+
+		for(int s = 0; s < NPOINTS * gptfloats; s += SLICEFLOATS)
+		{
+			if (gptfloats == 8)
+				_compute<SLICEPOINTS * 8>(myb, src + s, dst + s);
+			else
+				_compute<SLICEPOINTS * 16>(myb, src + s, dst + s);
+
+			retval = std::max(retval, sos.compute(dst + s, gptfloats, SLICEPOINTS));
+		}
+
+		return retval;
+	}
+};
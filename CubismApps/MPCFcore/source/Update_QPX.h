@@ -10,16 +10,20 @@
 #pragma once
 
 #include "Update.h"
+#include "MaxSpeedOfSound_QPX.h"
 
 struct Update_QPX : public Update_CPP
 {
 	enum {
 		NPOINTS = _BLOCKSIZE_ * _BLOCKSIZE_ * _BLOCKSIZE_, 
+		SLICEPOINTS = _BLOCKSIZE_ * _BLOCKSIZE_,
 		JUMP = sizeof(Real) * 4
 	};
 	
 public:
 	
+	typedef MaxSpeedOfSound_QPX SOSKernel;
+	
 	Update_QPX(const Real b = 1): Update_CPP(b) {}
 	
 	template<int NFLOATS, int STEP>
@@ -51,4 +55,31 @@ public:
 			abort();
 		}
 	}
+	
+	//see Update_CPP::compute_maxsos
+	Real compute_maxsos(const Real * const _src, Real * const dst, const int gptfloats) const
+	{
+		assert(gptfloats == 8 || gptfloats == 16);
+		
+		Real * src = const_cast<Real *>(_src);
+		
+		const SOSKernel sos;
+		vector4double myb1 = vec_splats(m_b);	
+		vector4double myb2 = vec_perm(vec_splats(m_b), vec_splats(0), vec_gpci(1114));	
+		const int SLICEFLOATS = SLICEPOINTS * gptfloats;
+		
+		Real retval = 0;
+		
+		for(int s = 0; s < NPOINTS * gptfloats; s += SLICEFLOATS)
+		{
+			if (gptfloats == 8)
+				_compute<SLICEPOINTS * 8, 8>(myb1, myb2, src + s, dst + s); 
+			else
+				_compute<SLICEPOINTS * 16, 16>(myb1, myb2, src + s, dst + s); 
+			
+			retval = std::max(retval, sos.compute(dst + s, gptfloats, SLICEPOINTS));
+		}
+		
+		return retval;
+	}
 };
@@ -0,0 +1,142 @@
+/*
+ *  WenoSOA2D_AVX.cpp
+ *  MPCFcore
+ *
+ */
+
+#include "WenoSOA2D_AVX.h"
+
+//same arithmetic as weno_minus/weno_plus in Convection_CPP.cpp
+inline vecreal _avx_weno_minus(const vecreal a, const vecreal b, const vecreal c, const vecreal d, const vecreal e)
+{
+	const vecreal is0 = avx_add(avx_mul(a, avx_add(avx_sub(avx_mul(a, avx_splat(4./3.)), avx_mul(b, avx_splat(19./3.))), avx_mul(c, avx_splat(11./3.)))),
+								avx_madd(b, avx_sub(avx_mul(b, avx_splat(25./3.)), avx_mul(c, avx_splat(31./3.))), avx_mul(avx_mul(c, c), avx_splat(10./3.))));
+	const vecreal is1 = avx_add(avx_mul(b, avx_add(avx_sub(avx_mul(b, avx_splat(4./3.)), avx_mul(c, avx_splat(13./3.))), avx_mul(d, avx_splat(5./3.)))),
+								avx_madd(c, avx_sub(avx_mul(c, avx_splat(13./3.)), avx_mul(d, avx_splat(13./3.))), avx_mul(avx_mul(d, d), avx_splat(4./3.))));
+	const vecreal is2 = avx_add(avx_mul(c, avx_add(avx_sub(avx_mul(c, avx_splat(10./3.)), avx_mul(d, avx_splat(31./3.))), avx_mul(e, avx_splat(11./3.)))),
+								avx_madd(d, avx_sub(avx_mul(d, avx_splat(25./3.)), avx_mul(e, avx_splat(19./3.))), avx_mul(avx_mul(e, e), avx_splat(4./3.))));
+
+	const vecreal is0plus = avx_add(is0, avx_splat(WENOEPS));
+	const vecreal is1plus = avx_add(is1, avx_splat(WENOEPS));
+	const vecreal is2plus = avx_add(is2, avx_splat(WENOEPS));
+
+	const vecreal alpha0 = avx_div(avx_splat(0.1), avx_mul(is0plus, is0plus));
+	const vecreal alpha1 = avx_div(avx_splat(0.6), avx_mul(is1plus, is1plus));
+	const vecreal alpha2 = avx_div(avx_splat(0.3), avx_mul(is2plus, is2plus));
+	const vecreal inv_alphasum = avx_div(avx_splat(1), avx_add(alpha0, avx_add(alpha1, alpha2)));
+
+	const vecreal omega0 = avx_mul(alpha0, inv_alphasum);
+	const vecreal omega1 = avx_mul(alpha1, inv_alphasum);
+	const vecreal omega2 = avx_sub(avx_sub(avx_splat(1), omega0), omega1);
+
+	const vecreal f0 = avx_madd(avx_splat(1./3.), a, avx_nmsub(avx_splat(7./6.), b, avx_mul(avx_splat(11./6.), c)));
+	const vecreal f1 = avx_madd(avx_splat(5./6.), c, avx_nmsub(avx_splat(1./6.), b, avx_mul(avx_splat(1./3.), d)));
+	const vecreal f2 = avx_madd(avx_splat(1./3.), c, avx_nmsub(avx_splat(1./6.), e, avx_mul(avx_splat(5./6.), d)));
+
+	return avx_madd(omega0, f0, avx_madd(omega1, f1, avx_mul(omega2, f2)));
+}
+
+inline vecreal _avx_weno_plus(const vecreal b, const vecreal c, const vecreal d, const vecreal e, const vecreal f)
+{
+	const vecreal is0 = avx_add(avx_mul(d, avx_add(avx_sub(avx_mul(d, avx_splat(10./3.)), avx_mul(e, avx_splat(31./3.))), avx_mul(f, avx_splat(11./3.)))),
+								avx_madd(e, avx_sub(avx_mul(e, avx_splat(25./3.)), avx_mul(f, avx_splat(19./3.))), avx_mul(avx_mul(f, f), avx_splat(4./3.))));
+	const vecreal is1 = avx_add(avx_mul(c, avx_add(avx_sub(avx_mul(c, avx_splat(4./3.)), avx_mul(d, avx_splat(13./3.))), avx_mul(e, avx_splat(5./3.)))),
+								avx_madd(d, avx_sub(avx_mul(d, avx_splat(13./3.)), avx_mul(e, avx_splat(13./3.))), avx_mul(avx_mul(e, e), avx_splat(4./3.))));
+	const vecreal is2 = avx_add(avx_mul(b, avx_add(avx_sub(avx_mul(b, avx_splat(4./3.)), avx_mul(c, avx_splat(19./3.))), avx_mul(d, avx_splat(11./3.)))),
+								avx_madd(c, avx_sub(avx_mul(c, avx_splat(25./3.)), avx_mul(d, avx_splat(31./3.))), avx_mul(avx_mul(d, d), avx_splat(10./3.))));
+
+	const vecreal is0plus = avx_add(is0, avx_splat(WENOEPS));
+	const vecreal is1plus = avx_add(is1, avx_splat(WENOEPS));
+	const vecreal is2plus = avx_add(is2, avx_splat(WENOEPS));
+
+	const vecreal alpha0 = avx_div(avx_splat(0.1), avx_mul(is0plus, is0plus));
+	const vecreal alpha1 = avx_div(avx_splat(0.6), avx_mul(is1plus, is1plus));
+	const vecreal alpha2 = avx_div(avx_splat(0.3), avx_mul(is2plus, is2plus));
+	const vecreal inv_alphasum = avx_div(avx_splat(1), avx_add(alpha0, avx_add(alpha1, alpha2)));
+
+	const vecreal omega0 = avx_mul(alpha0, inv_alphasum);
+	const vecreal omega1 = avx_mul(alpha1, inv_alphasum);
+	const vecreal omega2 = avx_sub(avx_sub(avx_splat(1), omega0), omega1);
+
+	const vecreal f0 = avx_madd(avx_splat(1./3.), f, avx_nmsub(avx_splat(7./6.), e, avx_mul(avx_splat(11./6.), d)));
+	const vecreal f1 = avx_madd(avx_splat(5./6.), d, avx_nmsub(avx_splat(1./6.), e, avx_mul(avx_splat(1./3.), c)));
+	const vecreal f2 = avx_madd(avx_splat(1./3.), d, avx_nmsub(avx_splat(1./6.), b, avx_mul(avx_splat(5./6.), c)));
+
+	return avx_madd(omega0, f0, avx_madd(omega1, f1, avx_mul(omega2, f2)));
+}
+
+//faces are BS+1: the last vector is shifted back so that it overlaps the previous one
+inline void _avx_xweno(const InputSOA& _in, TempSOA& _outm, TempSOA& _outp, const int NROWS)
+{
+	enum { LAST = TempSOA::NX - AVXLANES };
+
+	for(int iy=0; iy<NROWS; iy++)
+	{
+		const Real * const in = _in.ptr(-3, iy);
+		Real * const outm = &_outm.ref(0, iy);
+		Real * const outp = &_outp.ref(0, iy);
+
+		for(int ix=0; ix<TempSOA::NX; ix+=AVXLANES)
+		{
+			const int x = std::min(ix, (int)LAST);
+
+			const vecreal a = avx_loadu(in + x);
+			const vecreal b = avx_loadu(in + x + 1);
+			const vecreal c = avx_loadu(in + x + 2);
+			const vecreal d = avx_loadu(in + x + 3);
+			const vecreal e = avx_loadu(in + x + 4);
+			const vecreal f = avx_loadu(in + x + 5);
+
+			avx_storeu(outm + x, _avx_weno_minus(a, b, c, d, e));
+			avx_storeu(outp + x, _avx_weno_plus(b, c, d, e, f));
+		}
+	}
+}
+
+void WenoSOA2D_AVX::xcompute(const InputSOA& in, TempSOA& outm, TempSOA& outp) const
+{
+	_avx_xweno(in, outm, outp, TempSOA::NY);
+}
+
+void WenoSOA2D_AVX::ycompute(const InputSOA& in, TempSOA& outm, TempSOA& outp) const
+{
+	//the y-fluxes are stored transposed (see Convection_CPP::_yweno_minus),
+	//so we transpose the input once and reuse the x-sweep
+	InputSOA transposed;
+
+	for(int iy=-3; iy<_BLOCKSIZE_+3; iy++)
+		for(int ix=0; ix<_BLOCKSIZE_; ix++)
+			transposed.ref(iy, ix) = in(ix, iy);
+
+	_avx_xweno(transposed, outm, outp, _BLOCKSIZE_);
+}
+
+void WenoSOA2D_AVX::zcompute(const int r, const RingInputSOA& in, TempSOA& outm, TempSOA& outp) const
+{
+	const Real * const a = in(r-3).ptr(0,0);
+	const Real * const b = in(r-2).ptr(0,0);
+	const Real * const c = in(r-1).ptr(0,0);
+	const Real * const d = in(r).ptr(0,0);
+	const Real * const e = in(r+1).ptr(0,0);
+	const Real * const f = in(r+2).ptr(0,0);
+
+	Real * const om = &outm.ref(0,0);
+	Real * const op = &outp.ref(0,0);
+
+	for(int iy=0; iy<TempSOA::NY; iy++)
+		for(int ix=0; ix<_BLOCKSIZE_; ix+=AVXLANES)
+		{
+			const int src = ix + InputSOA::PITCH*iy;
+			const int dst = ix + TempSOA::PITCH*iy;
+
+			const vecreal A = avx_load(a + src);
+			const vecreal B = avx_load(b + src);
+			const vecreal C = avx_load(c + src);
+			const vecreal D = avx_load(d + src);
+			const vecreal E = avx_load(e + src);
+			const vecreal F = avx_load(f + src);
+
+			avx_store(om + dst, _avx_weno_minus(A, B, C, D, E));
+			avx_store(op + dst, _avx_weno_plus(B, C, D, E, F));
+		}
+}
@@ -0,0 +1,19 @@
+/*
+ *  WenoSOA2D_AVX.h
+ *  MPCFcore
+ *
+ */
+
+#pragma once
+
+#include "common.h"
+#include "AVX.h"
+
+class WenoSOA2D_AVX
+{
+public:
+
+	void xcompute(const InputSOA& in, TempSOA& outm, TempSOA& outp) const;
+	void ycompute(const InputSOA& in, TempSOA& outm, TempSOA& outp) const;
+	void zcompute(const int r, const RingInputSOA& in, TempSOA& outm, TempSOA& outp) const;
+};
@@ -8,9 +8,6 @@
  */
 
 #pragma once
-#ifdef _QPXEMU_
-#include "QPXEMU.h"
-#endif
 
 #include <cstdlib>
 #include <cmath>
@@ -26,6 +23,10 @@ typedef float Real;
 typedef double Real;
 #endif
 
+#ifdef _QPXEMU_
+#include "QPXEMU.h"
+#endif
+
 #ifndef _PREC_LEVEL_
 static const int preclevel = 0;
 #else
@@ -36,11 +37,49 @@ static const int preclevel = _PREC_LEVEL_;
 
 /*working dataset types */
 typedef SOA2D<-3, _BLOCKSIZE_+3, -3, _BLOCKSIZE_+3> InputSOA; 
-typedef RingSOA2D<-3, _BLOCKSIZE_+3, -3, _BLOCKSIZE_+3, 6> RingInputSOA; 
+typedef RingViewSOA2D<-3, _BLOCKSIZE_+3, -3, _BLOCKSIZE_+3, 6> RingInputSOA; 
 typedef SOA2D<0,_BLOCKSIZE_+1, 0,_BLOCKSIZE_> TempSOA; 
 typedef RingSOA2D<0, _BLOCKSIZE_+1, 0,_BLOCKSIZE_, 2> RingTempSOA; 
 typedef RingSOA2D<0,_BLOCKSIZE_+1, 0, _BLOCKSIZE_, 3> RingTempSOA3;
 
+//one z-slice of a SoA lab, in the primitive form read by the convection kernels
+struct InputSOASlice { InputSOA rho, u, v, w, p, G, P; };
+
+//the AoS points of a block and of its ghosts, read where they are (no lab copy).
+//along each direction a region spans the 3 ghosts below the block (-1), the block (0)
+//or the 3 ghosts above it (1), its point (ix, iy, iz) starting at first + gptfloats*(ix + row*iy + slice*iz)
+struct HaloRegion { const Real * first; int row, slice; };
+
+struct HaloSource
+{
+	HaloRegion region[27]; //region[cx+1 + 3*(cy+1 + 3*(cz+1))]
+	int gptfloats;
+
+	//the three pieces (x ghosts below, block, x ghosts above) of row dy of slice dz
+	void row(const int dy, const int dz, const Real * pieces[3]) const
+	{
+		const int cy = dy < 0 ? -1 : (dy < _BLOCKSIZE_ ? 0 : 1);
+		const int cz = dz < 0 ? -1 : (dz < _BLOCKSIZE_ ? 0 : 1);
+		const int ly = dy - (cy < 0 ? -3 : cy * _BLOCKSIZE_);
+		const int lz = dz - (cz < 0 ? -3 : cz * _BLOCKSIZE_);
+
+		for(int cx=-1; cx<2; cx++)
+		{
+			const HaloRegion& r = region[cx+1 + 3*(cy+1 + 3*(cz+1))];
+
+			pieces[cx+1] = r.first + gptfloats * (r.row * ly + r.slice * lz);
+		}
+	}
+
+	//point dx of a row, from -3 to BLOCKSIZE+2
+	const Real * point(const Real * const pieces[3], const int dx) const
+	{
+		if (dx < 0) return pieces[0] + gptfloats * (dx + 3);
+
+		return dx < _BLOCKSIZE_ ? pieces[1] + gptfloats * dx : pieces[2] + gptfloats * (dx - _BLOCKSIZE_);
+	}
+};
+
 
 //C++ related functions
 template<typename X> inline X mysqrt(X x){ abort(); return sqrt(x);}
@@ -166,7 +205,7 @@ int mysqrt_flops()
 inline vector4double mymin(const vector4double a, const vector4double b)
 {
 #ifdef _QPXEMU_
-	return _mm_min_ps(a,b);
+	return QPXSIMD::min(a, b);
 #else
 	return vec_sel(a, b, vec_cmpgt(a, b));
 #endif
@@ -175,7 +214,7 @@ inline vector4double mymin(const vector4double a, const vector4double b)
 inline vector4double mymax(const vector4double a, const vector4double b)
 {
 #ifdef _QPXEMU_
-	return _mm_max_ps(a,b);
+	return QPXSIMD::max(a, b);
 #else
 	return vec_sel(a, b, vec_cmplt(a, b));
 #endif
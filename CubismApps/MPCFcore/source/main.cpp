@@ -43,6 +43,12 @@ extern "C" void HPM_Stop(char *);
 #include "MaxSpeedOfSound_QPX.h"
 #endif
 
+#ifdef _AVX_
+#include "Convection_AVX.h"
+#include "Update_AVX.h"
+#include "MaxSpeedOfSound_AVX.h"
+#endif
+
 #include "Update.h"
 #include "MaxSpeedOfSound.h"
 
@@ -105,7 +111,7 @@ int main (int argc, const char ** argv)
 	ArgumentParser parser(argc, argv);
 	parser.loud();	
 	//enable/disable the handling of denormalized numbers
-#ifdef _QPXEMU_
+#if defined(_QPXEMU_) || defined(_AVX_)
 	if (parser("-f2z").asBool(false))
 #pragma omp parallel
 	{
@@ -129,7 +135,7 @@ int main (int argc, const char ** argv)
 	info.peakbandwidth = parser("-pb").asDouble(4.5);
 	
 	//numerical discrepancies greater than this threshold will be reported
-	info.accuracythreshold = parser("-accuracy").asDouble(1e-4);
+	info.accuracythreshold = parser("-accuracy").asDouble(sizeof(Real) == sizeof(float) ? 1e-4 : 1e-6);
 	
 	//memory footprint per thread, in terms of blocks.
 	info.nofblocks = parser("-nblocks").asInt(50);
@@ -152,6 +158,7 @@ int main (int argc, const char ** argv)
 			if (kernel == "Update_CPP" || kernel == "all")
 			{
 				Update_CPP update_kernel;
+				lt.accuracy_maxsos(update_kernel, info.accuracythreshold);
 				HPM_Start("Update_CPP");
 				lt.profile_update(update_kernel, info.peakperf, info.peakbandwidth, info.nofblocks, info.noftimes);
 				HPM_Stop("Update_CPP");
@@ -190,6 +197,7 @@ int main (int argc, const char ** argv)
 			Update_CPP refkernel;
 			Update_QPX update_kernel;
 			lt.accuracy(update_kernel, refkernel, info.accuracythreshold);
+			lt.accuracy_maxsos(update_kernel, info.accuracythreshold);
 			
 			HPM_Start("Update_QPX");
 			lt.profile_update(update_kernel, info.peakperf, info.peakbandwidth, info.nofblocks, info.noftimes);
@@ -197,6 +205,38 @@ int main (int argc, const char ** argv)
 		}
 	}
 #endif
+
+	//AVX kernels
+#ifdef _AVX_
+	{
+		if (kernel == "Convection_AVX" || kernel == "all")
+			testing(Test_Convection(), Convection_AVX(0, 1), info);
+
+		Test_LocalKernel lt;
+
+		if (kernel == "MaxSOS_AVX" || kernel == "all")
+		{
+			MaxSpeedOfSound_AVX maxsos_kernel;
+			MaxSpeedOfSound_CPP refkernel;
+			lt.accuracy(maxsos_kernel, refkernel, info.accuracythreshold);
+			HPM_Start("MaxSOS_AVX");
+			lt.profile_maxsos(maxsos_kernel, info.peakperf, info.peakbandwidth, info.nofblocks, info.noftimes);
+			HPM_Stop("MaxSOS_AVX");
+		}
+
+		if (kernel == "Update_AVX" || kernel == "all")
+		{
+			Update_CPP refkernel;
+			Update_AVX update_kernel;
+			lt.accuracy(update_kernel, refkernel, info.accuracythreshold);
+			lt.accuracy_maxsos(update_kernel, info.accuracythreshold);
+
+			HPM_Start("Update_AVX");
+			lt.profile_update(update_kernel, info.peakperf, info.peakbandwidth, info.nofblocks, info.noftimes);
+			HPM_Stop("Update_AVX");
+		}
+	}
+#endif
 		
 #ifdef _USE_HPM_
 	MPI_Finalize();
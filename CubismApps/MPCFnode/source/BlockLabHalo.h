@@ -0,0 +1,101 @@
+/*
+ *  BlockLabHalo.h
+ *  MPCFnode
+ *
+ */
+#pragma once
+
+#include <BlockLab.h>
+#include <common.h>
+
+#include "Types.h"
+
+//lab for the convection kernels, it copies nothing: the kernels read the block and the
+//ghosts in the neighbor blocks where they are, through a HaloSource. edges and corners
+//are read from the diagonal neighbors if the lab is tensorial, they are zero otherwise.
+//blocks at a non-periodic boundary are loaded by TLab (for its boundary conditions)
+//and read from its cache, as are all the blocks if FluidBlock is not AoS.
+template<typename TLab>
+class BlockLabHalo : public TLab
+{
+	HaloSource m_src;
+
+	//the edges and corners of a lab that is not tensorial
+	static const Real * _zeros()
+	{
+		static const FluidElement zeros[_BLOCKSIZE_] = { };
+
+		return &zeros[0].rho;
+	}
+
+	bool _skin(const BlockInfo& info)
+	{
+		const bool xskin = !this->is_xperiodic() && (info.index[0]==0 || info.index[0]==this->m_refGrid->getBlocksPerDimension(0)-1);
+		const bool yskin = !this->is_yperiodic() && (info.index[1]==0 || info.index[1]==this->m_refGrid->getBlocksPerDimension(1)-1);
+		const bool zskin = !this->is_zperiodic() && (info.index[2]==0 || info.index[2]==this->m_refGrid->getBlocksPerDimension(2)-1);
+
+		return xskin || yskin || zskin;
+	}
+
+public:
+
+	BlockLabHalo(): TLab() { m_src.gptfloats = FluidBlock::gptfloats; }
+
+	//the lower z-ghosts are always read
+	void load(const BlockInfo& info, const Real t=0, const bool applybc=true, const bool=true)
+	{
+		assert(this->m_stencilStart[0] == -3 && this->m_stencilStart[1] == -3 && this->m_stencilStart[2] == -3);
+		assert(this->m_stencilEnd[0] == 4 && this->m_stencilEnd[1] == 4 && this->m_stencilEnd[2] == 4);
+
+#if _LAYOUT_AOS_
+		if (!_skin(info))
+		{
+			const FluidGridBase& grid = *this->m_refGrid;
+			const int * const index = info.index;
+
+			for(int i=0; i<27; i++)
+			{
+				const int code[3] = { i%3 - 1, (i/3)%3 - 1, i/9 - 1 };
+
+				if (!this->istensorial && abs(code[0]) + abs(code[1]) + abs(code[2]) > 1)
+				{
+					const HaloRegion r = { _zeros(), 0, 0 };
+					m_src.region[i] = r;
+
+					continue;
+				}
+
+				const FluidBlock& b = i == 13 ? *(FluidBlock *)info.ptrBlock : grid(index[0] + code[0], index[1] + code[1], index[2] + code[2]);
+				const int s[3] = { code[0] < 0 ? _BLOCKSIZE_-3 : 0, code[1] < 0 ? _BLOCKSIZE_-3 : 0, code[2] < 0 ? _BLOCKSIZE_-3 : 0 };
+
+				const HaloRegion r = { &b(s[0], s[1], s[2]).rho, _BLOCKSIZE_, _BLOCKSIZE_ * _BLOCKSIZE_ };
+				m_src.region[i] = r;
+			}
+
+			return;
+		}
+#endif
+
+		TLab::load(info, t, applybc);
+
+		const int row = this->template getActualSize<0>();
+		const int slice = row * this->template getActualSize<1>();
+
+		for(int i=0; i<27; i++)
+		{
+			const int code[3] = { i%3 - 1, (i/3)%3 - 1, i/9 - 1 };
+			const int s[3] = { code[0] < 0 ? -3 : code[0] * _BLOCKSIZE_, code[1] < 0 ? -3 : code[1] * _BLOCKSIZE_, code[2] < 0 ? -3 : code[2] * _BLOCKSIZE_ };
+
+			const HaloRegion r = { &TLab::read(s[0], s[1], s[2]).rho, row, slice };
+			m_src.region[i] = r;
+		}
+	}
+
+	//nothing to slide
+	void load_xnext(const BlockInfo& info, const Real t=0, const bool applybc=true)
+	{
+		load(info, t, applybc);
+	}
+
+	const HaloSource& source() const { return m_src; }
+};
@@ -0,0 +1,176 @@
+/*
+ *  BlockLabSOA.h
+ *  MPCFnode
+ *
+ */
+#pragma once
+
+#include <cstring>
+
+#include <BlockLab.h>
+#include <common.h>
+
+#include "Types.h"
+
+//lab for the convection kernels, it gathers the block and its face ghosts directly
+//into one InputSOASlice per z-slice, in primitive form. the kernels bind these slices
+//to their rings, there is no AoS -> SoA conversion left in compute(.).
+//blocks at a non-periodic boundary are loaded by TLab (for its boundary conditions)
+//and converted afterwards. edges and corners of the lab are not loaded.
+template<typename TLab>
+class BlockLabSOA : public TLab
+{
+	enum { NSLICES = _BLOCKSIZE_ + 6 };
+
+	InputSOASlice * m_slices;
+
+	//points [sx, ex) of row iy, the x-th point being row[x].
+	//the conserved quantities are scattered first, then turned into primitive ones
+	//in place: both loops are unit-stride on the SoA side and vectorize
+	static inline void _convert(const FluidElement * const row, InputSOASlice& slice, const int iy, const int sx, const int ex)
+	{
+		Real * const r = &slice.rho.ref(0, iy), * const u = &slice.u.ref(0, iy), * const v = &slice.v.ref(0, iy);
+		Real * const w = &slice.w.ref(0, iy), * const p = &slice.p.ref(0, iy), * const G = &slice.G.ref(0, iy);
+		Real * const P = &slice.P.ref(0, iy);
+
+		for(int ix=sx; ix<ex; ix++)
+		{
+			const FluidElement& pt = row[ix];
+
+			r[ix] = pt.rho;
+			u[ix] = pt.u;
+			v[ix] = pt.v;
+			w[ix] = pt.w;
+			p[ix] = pt.energy;
+			G[ix] = pt.G;
+			P[ix] = pt.P;
+		}
+
+		_primitive(slice, iy, sx, ex);
+	}
+
+#if !_LAYOUT_AOS_
+	//same as above for a block stored in another layout (layout=soa|aosoa),
+	//the x-th point of the row being the point ip0 + x of the block
+	static inline void _convert(const FluidBlock& b, const int ip0, InputSOASlice& slice, const int iy, const int sx, const int ex)
+	{
+		Real * const dst[7] = {
+			&slice.rho.ref(0, iy), &slice.u.ref(0, iy), &slice.v.ref(0, iy), &slice.w.ref(0, iy),
+			&slice.p.ref(0, iy), &slice.G.ref(0, iy), &slice.P.ref(0, iy)
+		};
+
+		for(int c=0; c<7; c++)
+			for(int ix=sx; ix<ex; ix++)
+				dst[c][ix] = b.data[FluidBlock::offset(ip0 + ix, c)];
+
+		_primitive(slice, iy, sx, ex);
+	}
+#endif
+
+	static inline void _primitive(InputSOASlice& slice, const int iy, const int sx, const int ex)
+	{
+		const Real * const r = &slice.rho.ref(0, iy);
+		Real * const u = &slice.u.ref(0, iy), * const v = &slice.v.ref(0, iy), * const w = &slice.w.ref(0, iy);
+		Real * const p = &slice.p.ref(0, iy);
+		const Real * const G = &slice.G.ref(0, iy), * const P = &slice.P.ref(0, iy);
+
+		for(int ix=sx; ix<ex; ix++)
+		{
+			const Real myu = u[ix], myv = v[ix], myw = w[ix];
+
+			u[ix] = myu/r[ix];
+			v[ix] = myv/r[ix];
+			w[ix] = myw/r[ix];
+			p[ix] = (p[ix] - ( (myu*myu + myv*myv + myw*myw)*(((Real)0.5)/r[ix])+P[ix] ))/G[ix];
+		}
+	}
+
+	//rows [sx, ex) x [sy, ey) of slice iz, taken from block b shifted by (ox, oy, oz) blocks
+	static inline void _gather(const FluidBlock& b, InputSOASlice& slice, const int iz,
+							   const int sx, const int ex, const int sy, const int ey, const int ox, const int oy, const int oz)
+	{
+		const int bz = iz - oz * _BLOCKSIZE_;
+
+		for(int iy=sy; iy<ey; iy++)
+#if _LAYOUT_AOS_
+			_convert(&b.data[bz][iy - oy * _BLOCKSIZE_][0] - ox * _BLOCKSIZE_, slice, iy, sx, ex);
+#else
+			_convert(b, _BLOCKSIZE_ * (iy - oy * _BLOCKSIZE_ + _BLOCKSIZE_ * bz) - ox * _BLOCKSIZE_, slice, iy, sx, ex);
+#endif
+	}
+
+	bool _skin(const BlockInfo& info)
+	{
+		const bool xskin = !this->is_xperiodic() && (info.index[0]==0 || info.index[0]==this->m_refGrid->getBlocksPerDimension(0)-1);
+		const bool yskin = !this->is_yperiodic() && (info.index[1]==0 || info.index[1]==this->m_refGrid->getBlocksPerDimension(1)-1);
+		const bool zskin = !this->is_zperiodic() && (info.index[2]==0 || info.index[2]==this->m_refGrid->getBlocksPerDimension(2)-1);
+
+		return xskin || yskin || zskin;
+	}
+
+public:
+
+	BlockLabSOA(): TLab(), m_slices(NULL)
+	{
+		const int error = posix_memalign((void **)&m_slices, std::max(8, _ALIGNBYTES_), sizeof(InputSOASlice) * NSLICES);
+		assert(error == 0);
+
+		//what is not loaded (edges, corners) is read by the vector kernels, but never used
+		memset((void *)m_slices, 0, sizeof(InputSOASlice) * NSLICES);
+	}
+
+	~BlockLabSOA() { free(m_slices); }
+
+	//the lower z-ghosts are always loaded: the slices are bound to the rings of the kernels,
+	//streaming along z would leave the rings with the slices of the previous block
+	void load(const BlockInfo& info, const Real t=0, const bool applybc=true, const bool=true)
+	{
+		assert(this->m_stencilStart[0] == -3 && this->m_stencilStart[1] == -3 && this->m_stencilStart[2] == -3);
+		assert(this->m_stencilEnd[0] == 4 && this->m_stencilEnd[1] == 4 && this->m_stencilEnd[2] == 4);
+
+		if (_skin(info))
+		{
+			TLab::load(info, t, applybc);
+
+			for(int iz=-3; iz<_BLOCKSIZE_+3; iz++)
+				for(int iy=-3; iy<_BLOCKSIZE_+3; iy++)
+					_convert(&TLab::read(-3, iy, iz) + 3, m_slices[iz + 3], iy, -3, _BLOCKSIZE_+3);
+
+			return;
+		}
+
+		const FluidGridBase& grid = *this->m_refGrid;
+		const int * const i = info.index;
+
+		const FluidBlock& b = *(FluidBlock *)info.ptrBlock;
+		const FluidBlock& xm = grid(i[0]-1, i[1], i[2]), &xp = grid(i[0]+1, i[1], i[2]);
+		const FluidBlock& ym = grid(i[0], i[1]-1, i[2]), &yp = grid(i[0], i[1]+1, i[2]);
+		const FluidBlock& zm = grid(i[0], i[1], i[2]-1), &zp = grid(i[0], i[1], i[2]+1);
+
+		for(int iz=-3; iz<0; iz++)
+			_gather(zm, m_slices[iz + 3], iz, 0, _BLOCKSIZE_, 0, _BLOCKSIZE_, 0, 0, -1);
+
+		for(int iz=0; iz<_BLOCKSIZE_; iz++)
+		{
+			InputSOASlice& slice = m_slices[iz + 3];
+
+			_gather(ym, slice, iz, 0, _BLOCKSIZE_, -3, 0, 0, -1, 0);
+			_gather(xm, slice, iz, -3, 0, 0, _BLOCKSIZE_, -1, 0, 0);
+			_gather(b, slice, iz, 0, _BLOCKSIZE_, 0, _BLOCKSIZE_, 0, 0, 0);
+			_gather(xp, slice, iz, _BLOCKSIZE_, _BLOCKSIZE_+3, 0, _BLOCKSIZE_, 1, 0, 0);
+			_gather(yp, slice, iz, 0, _BLOCKSIZE_, _BLOCKSIZE_, _BLOCKSIZE_+3, 0, 1, 0);
+		}
+
+		for(int iz=_BLOCKSIZE_; iz<_BLOCKSIZE_+3; iz++)
+			_gather(zp, m_slices[iz + 3], iz, 0, _BLOCKSIZE_, 0, _BLOCKSIZE_, 0, 0, 1);
+	}
+
+	//the slices are gathered again from the blocks
+	void load_xnext(const BlockInfo& info, const Real t=0, const bool applybc=true)
+	{
+		load(info, t, applybc);
+	}
+
+	//the slice at z = -3, followed by the other BLOCKSIZE+5
+	const InputSOASlice * soa() const { return m_slices; }
+};
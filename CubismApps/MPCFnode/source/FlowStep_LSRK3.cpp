@@ -7,6 +7,7 @@
  *
  */
 #include <vector>
+#include <algorithm>
 
 #include <utility>
 #include <iostream>
@@ -16,6 +17,9 @@
 
 #include <Timer.h>
 #include <Profiler.h>
+#include <Indexers.h>
+#include <LabPool.h>
+#include <BlockSchedule.h>
 #include <Convection_CPP.h>
 
 #if defined(_QPX_) || defined(_QPXEMU_)
@@ -32,6 +36,12 @@
 #endif
 #endif
 
+#ifdef _AVX_
+#include <Convection_AVX.h>
+#include <Update_AVX.h>
+#include <MaxSpeedOfSound_AVX.h>
+#endif
+
 #include <Update.h>
 #include <MaxSpeedOfSound.h>
 
@@ -47,6 +57,8 @@ extern "C" void HPM_Stop(char *);
 using namespace std;
 
 #include "FlowStep_LSRK3.h"
+#include "BlockLabSOA.h"
+#include "BlockLabHalo.h"
 #include "Tests.h"
 
 namespace LSRK3data
@@ -62,69 +74,183 @@ namespace LSRK3data
 	float PEAKPERF_CORE, PEAKBAND;
 	
 	string dispatcher;
+	string lab;
+	bool fused;
+	bool wavefront;
+	bool quiescent;
 	
 	int step_id = 0;
     int ReportFreq = 1;
 }
 
+//orders the blocks as columns along dim (2: z, 0: x rows): ids[columns[c]..columns[c+1]-1] are
+//the blocks of column c, in increasing order and without gaps along dim
+struct ColumnOrder
+{
+	const BlockInfo * ary;
+	int dim;
+
+	ColumnOrder(const BlockInfo * ary, const int dim): ary(ary), dim(dim) { }
+
+	bool operator()(const int a, const int b) const
+	{
+		const int * const ia = ary[a].index, * const ib = ary[b].index;
+		const int d1 = (dim + 1) % 3, d2 = (dim + 2) % 3;
+
+		if (ia[d1] != ib[d1]) return ia[d1] < ib[d1];
+		if (ia[d2] != ib[d2]) return ia[d2] < ib[d2];
+
+		return ia[dim] < ib[dim];
+	}
+};
+
+void _columns(const BlockInfo * const ary, const int N, const int dim, vector<int>& ids, vector<int>& columns)
+{
+	ids.resize(N);
+	for(int i=0; i<N; i++)
+		ids[i] = i;
+
+	sort(ids.begin(), ids.end(), ColumnOrder(ary, dim));
+
+	const int d1 = (dim + 1) % 3, d2 = (dim + 2) % 3;
+
+	columns.clear();
+	for(int i=0; i<N; i++)
+	{
+		const int * const curr = ary[ids[i]].index;
+		const int * const prev = i > 0 ? ary[ids[i-1]].index : NULL;
+
+		if (prev == NULL || prev[d1] != curr[d1] || prev[d2] != curr[d2] || prev[dim] + 1 != curr[dim])
+			columns.push_back(i);
+	}
+	columns.push_back(N);
+}
+
+template<typename Lab, typename Kernel>
+inline void _compute(Lab& mylab, Kernel& kernel, Real * const destfirst, const bool zstream)
+{
+	const Real * const srcfirst = &mylab(-3,-3,-3).rho;
+	const int labSizeRow = mylab.template getActualSize<0>();
+	const int labSizeSlice = labSizeRow*mylab.template getActualSize<1>();
+
+	if (zstream)
+		kernel.compute_zstream(srcfirst, FluidBlock::gptfloats, labSizeRow, labSizeSlice,
+							   destfirst, FluidBlock::gptfloats, FluidBlock::sizeX, FluidBlock::sizeX*FluidBlock::sizeY);
+	else
+		kernel.compute(srcfirst, FluidBlock::gptfloats, labSizeRow, labSizeSlice,
+					   destfirst, FluidBlock::gptfloats, FluidBlock::sizeX, FluidBlock::sizeX*FluidBlock::sizeY);
+}
+
+//the kernel reads the slices of the SoA lab, always with a full warm-up
+template<typename Lab, typename Kernel>
+inline void _compute(BlockLabSOA<Lab>& mylab, Kernel& kernel, Real * const destfirst, const bool)
+{
+	kernel.compute(mylab.soa(), destfirst, FluidBlock::gptfloats, FluidBlock::sizeX, FluidBlock::sizeX*FluidBlock::sizeY);
+}
+
+//the kernel reads the block and its ghosts in place, always with a full warm-up
+template<typename Lab, typename Kernel>
+inline void _compute(BlockLabHalo<Lab>& mylab, Kernel& kernel, Real * const destfirst, const bool)
+{
+	kernel.compute(mylab.source(), destfirst, FluidBlock::gptfloats, FluidBlock::sizeX, FluidBlock::sizeX*FluidBlock::sizeY);
+}
+
 template<typename Lab, typename Kernel>
-void _process(const Real a, const Real dtinvh, vector<BlockInfo>& myInfo, FluidGrid& grid, const Real t=0, bool tensorial=false)
+inline void _process_block(Lab& mylab, Kernel& kernel, const BlockInfo& info, const Real t, const bool zstream, Timer& timer, double& lab_time, const bool xnext=false)
 {
-	const int stencil_start[3] = {-3,-3,-3};
-	const int stencil_end[3] = {4,4,4};
-	BlockInfo * ary = &myInfo.front();
+	//we want to measure the time spent in ghost reconstruction
+	timer.start();
+	if (xnext)
+		mylab.load_xnext(info, t);
+	else
+		mylab.load(info, t, true, !zstream);
+	lab_time += timer.stop();
+
+	_compute(mylab, kernel, &((FluidBlock*)info.ptrBlock)->tmp[0][0][0][0], zstream);
+}
+
+//the stencil of the convection kernels
+StencilInfo _stencil(const bool tensorial)
+{
+	return StencilInfo(-3,-3,-3,4,4,4, tensorial, 7, 0,1,2,3,4,5,6);
+}
+
+//fused != NULL: the update of the blocks is run during the sweep (see LSRK3data::FusedUpdate)
+template<typename Lab, typename Kernel, typename TFused>
+void _process(const Real a, const Real dtinvh, const vector<BlockInfo>& myInfo, FluidGrid& grid, TFused * const fused, const Real t=0, bool tensorial=false)
+{
+	const BlockInfo * const ary = &myInfo.front();
 	const int N = myInfo.size();
 	
 	const int NTH = omp_get_max_threads();
 	double total_time[NTH];
+	int nquiescent[NTH];
 
-	static Lab * labs = NULL;
-
-	if (labs == NULL)
-	{
-		printf("allocating %d labs\n", NTH); fflush(0);
-
-		labs = new Lab[NTH];
-		for(int i = 0; i < NTH; ++i)
-			labs[i].prepare(grid, stencil_start, stencil_end, tensorial);
-	}
+	const StencilInfo stencil = _stencil(tensorial);
+	
+	//-dispatcher column: each thread takes whole columns of blocks along z and streams
+	//them through its kernel, the rings and the lower z-ghosts of a block are those of the previous one.
+	//-dispatcher row: same with rows along x, the lab slides from a block to the next (see BlockLab::load_xnext)
+	const bool bColumns = LSRK3data::dispatcher == "column";
+	const bool bRows = LSRK3data::dispatcher == "row";
+	
+	vector<int> ids, columns;
+	if (bColumns || bRows) _columns(ary, N, bRows ? 0 : 2, ids, columns);
+	
+	const int NC = (int)columns.size() - 1;
+	
+	//the blocks of a column or a row are streamed, the update of a block is fused with the RHS of its readers
+	const bool bQuiescent = LSRK3data::quiescent && !bColumns && !bRows && !fused;
+	if (bQuiescent) LSRK3data::mark_uniform(myInfo, grid);
+	
+	//a column goes to the NUMA domain of its first block
+	vector<int> coldomains(max(NC, 0));
+	for(int c=0; c<NC; c++)
+		coldomains[c] = grid.getNUMADomain(ary[ids[columns[c]]]);
+	
+	BlockSchedule schedule = bColumns || bRows ? BlockSchedule(coldomains) : BlockSchedule(myInfo, grid);
 	
 #pragma omp parallel
 	{
-#ifdef _USE_NUMA_
-        const int cores_per_node = numa_num_configured_cpus() / numa_num_configured_nodes();
-        const int mynode = omp_get_thread_num() / cores_per_node;
-	numa_run_on_node(mynode);
-#endif
+		NUMAPartition::bind();
 		
 		const int tid = omp_get_thread_num();
 		total_time[tid] = 0;
+		nquiescent[tid] = 0;
 		
 		Timer timer;
 		Kernel kernel(a, dtinvh);
 		
-		Lab& mylab = labs[tid];
-//		Lab mylab;
-//		mylab.prepare(grid, stencil_start, stencil_end, tensorial);
+		Lab& mylab = LabPool<Lab>::get(grid, stencil);
 
-#pragma omp for schedule(runtime)
-		for(int i=0; i<N; i++)
+		if (bColumns || bRows)
 		{
-			//we want to measure the time spent in ghost reconstruction
-			timer.start();
-			mylab.load(ary[i], t);
-			total_time[tid] += timer.stop();
-			
-            const Real * const srcfirst = &mylab(-3,-3,-3).rho;
-            const int labSizeRow = mylab.template getActualSize<0>();
-            const int labSizeSlice = labSizeRow*mylab.template getActualSize<1>();
-			
-			Real * const destfirst = &((FluidBlock*)ary[i].ptrBlock)->tmp[0][0][0][0];
-			
-			kernel.compute(srcfirst, FluidBlock::gptfloats, labSizeRow, labSizeSlice, 
-						   destfirst, FluidBlock::gptfloats, FluidBlock::sizeX, FluidBlock::sizeX*FluidBlock::sizeY);
+			for(int c=schedule.next(); c>=0; c=schedule.next())
+				for(int i=columns[c]; i<columns[c+1]; i++)
+				{
+					_process_block(mylab, kernel, ary[ids[i]], t, bColumns && i > columns[c], timer, total_time[tid], bRows && i > columns[c]);
+
+					if (fused) fused->done(ids[i]);
+				}
+		}
+		else
+		{
+			for(int i=schedule.next(); i>=0; i=schedule.next())
+			{
+				if (bQuiescent && LSRK3data::skip(ary[i], grid, a))
+				{
+					nquiescent[tid]++;
+					continue;
+				}
+				
+				_process_block(mylab, kernel, ary[i], t, false, timer, total_time[tid]);
+
+				if (fused) fused->done(i);
+			}
 		}
 		
+#pragma omp barrier
+		
 #pragma omp single
 		{
 			double min_val = total_time[0], max_val = total_time[0], sum = total_time[0];
@@ -138,18 +264,181 @@ void _process(const Real a, const Real dtinvh, vector<BlockInfo>& myInfo, FluidG
 			
 			if (LSRK3data::verbosity >= 1)
 				printf("(min,max,avg) of lab.load() is (%5.10e, %5.10e, %5.10e)\n", min_val, max_val, sum/NTH);
+			
+			if (bQuiescent && LSRK3data::verbosity >= 1)
+			{
+				int nskipped = 0;
+				for(int i=0; i<NTH; i++)
+					nskipped += nquiescent[i];
+				
+				printf("quiescent blocks: %d of %d\n", nskipped, N);
+			}
 		}
 	}
 }
 
+//the blocks in Morton order of their index
+struct MortonOrder
+{
+	const BlockInfo * ary;
+	IndexerMorton indexer;
+
+	MortonOrder(const BlockInfo * ary, const int maxnd): ary(ary), indexer(maxnd, maxnd, maxnd) { }
+
+	bool operator()(const int a, const int b) const
+	{
+		const int * const ia = ary[a].index, * const ib = ary[b].index;
+
+		return indexer.encode(ia[0], ia[1], ia[2]) < indexer.encode(ib[0], ib[1], ib[2]);
+	}
+};
+
+//-wavefront 1: temporal blocking of the three substeps. a task is the RHS or the update of
+//one block at one substep, it is run as soon as its dependencies are met:
+//- the RHS of block i at substep s waits for the updates at s-1 of the blocks read by its lab
+//- the update of block i at substep s waits for the RHS at s of the labs reading block i.
+//the RHS of the first substep are taken in Morton order, each thread then runs depth-first
+//the tasks it made ready: a group of neighboring blocks goes through the three substeps while
+//it is in cache. each block sees the same operations on the same data as in the
+//bulk-synchronous path. with sos, the last update returns the max characteristic speed
+template<typename Lab, typename Kflow, typename Kupdate>
+Real _wavefront(const Real a[3], const Real b[3], const Real dtinvh, const vector<BlockInfo>& myInfo, FluidGrid& grid, const bool sos, const Real t=0, bool tensorial=false)
+{
+	enum { NSTAGES = 3 };
+	
+	const BlockInfo * const ary = &myInfo.front();
+	const int N = myInfo.size();
+	
+	const StencilInfo stencil = _stencil(tensorial);
+	
+	const LSRK3data::Readers readers(myInfo, grid, tensorial);
+	
+	//pending[s][i]: for the RHS, updates at s-1 still to be done, for the update, RHS at s
+	vector<int> pendingrhs(NSTAGES * N), pendingupdate(NSTAGES * N);
+	for(int s=0; s<NSTAGES; ++s)
+		for(int i=0; i<N; ++i)
+		{
+			pendingrhs[s * N + i] = s == 0 ? 0 : readers.count(i);
+			pendingupdate[s * N + i] = readers.count(i);
+		}
+	
+	vector<Real> blocksos(N, 0);
+	
+	vector<int> seeds(N);
+	for(int i=0; i<N; i++)
+		seeds[i] = i;
+	
+	sort(seeds.begin(), seeds.end(), MortonOrder(ary, max(grid.getBlocksPerDimension(0), max(grid.getBlocksPerDimension(1), grid.getBlocksPerDimension(2)))));
+	
+#pragma omp parallel
+	{
+		NUMAPartition::bind();
+		
+		Timer timer;
+		double lab_time = 0;
+		
+		Lab& mylab = LabPool<Lab>::get(grid, stencil);
+		
+		//tasks made ready by this thread: (block, 2 * substep + 1 if update)
+		vector< pair<int, int> > todo;
+		
+#pragma omp for schedule(dynamic, 1)
+		for(int m=0; m<N; m++)
+		{
+			todo.push_back(make_pair(seeds[m], 0));
+			
+			while(!todo.empty())
+			{
+				const int i = todo.back().first;
+				const int s = todo.back().second / 2;
+				const bool bUpdate = todo.back().second % 2;
+				todo.pop_back();
+				
+#pragma omp flush
+				if (bUpdate)
+				{
+					const LSRK3data::Update<Kupdate> update(b[s], ary);
+					const Kupdate kernel(b[s]);
+					
+					if (sos && s == NSTAGES - 1)
+						blocksos[i] = update.maxsos(kernel, *(FluidBlock *)ary[i].ptrBlock);
+					else
+						update(kernel, *(FluidBlock *)ary[i].ptrBlock);
+				}
+				else
+				{
+					Kflow kernel(a[s], dtinvh);
+					
+					_process_block(mylab, kernel, ary[i], t, false, timer, lab_time);
+				}
+#pragma omp flush
+				
+				if (bUpdate && s == NSTAGES - 1) continue;
+				
+				vector<int>& pending = bUpdate ? pendingrhs : pendingupdate;
+				const int next = bUpdate ? s + 1 : s;
+				
+				for(int k=readers.start[i]; k<readers.start[i+1]; ++k)
+				{
+					const int j = readers.readers[k];
+					
+					if (LSRK3data::decrement(pending[next * N + j]) == 0)
+						todo.push_back(make_pair(j, 2 * next + !bUpdate));
+				}
+			}
+		}
+	}
+	
+	return (sos && N > 0) ? *max_element(blocksos.begin(), blocksos.end()) : 0;
+}
+
+//the SOS kernels read AoS grid points: with another layout (layout=soa|aosoa)
+//the block is first copied into aos, which holds FluidBlock::NPOINTS elements
+#if _LAYOUT_AOS_
+template<typename TSOS>
+inline Real _sos(const TSOS& kernel, FluidBlock& block, FluidElement * const)
+{
+	return kernel.compute(&block.data[0][0][0].rho, FluidBlock::gptfloats);
+}
+#else
+template<typename TSOS>
+inline Real _sos(const TSOS& kernel, FluidBlock& block, FluidElement * const aos)
+{
+	for(int iz=0; iz<FluidBlock::sizeZ; iz++)
+		for(int iy=0; iy<FluidBlock::sizeY; iy++)
+			for(int ix=0; ix<FluidBlock::sizeX; ix++)
+				aos[ix + FluidBlock::sizeX * (iy + FluidBlock::sizeY * iz)] = block(ix, iy, iz);
+
+	return kernel.compute(&aos[0].rho, FluidBlock::gptfloats);
+}
+#endif
+
+struct SOSBuffer
+{
+	FluidElement * aos;
+
+	SOSBuffer(): aos(NULL)
+	{
+#if !_LAYOUT_AOS_
+		const int error = posix_memalign((void **)&aos, std::max(8, _ALIGNBYTES_), sizeof(FluidElement) * FluidBlock::NPOINTS);
+		assert(error == 0);
+#endif
+	}
+
+	~SOSBuffer() { free(aos); }
+};
+
 template < typename TSOS>
 Real _computeSOS_OMP(FluidGrid& grid,  bool bAwk)
 {
-    vector<BlockInfo> vInfo = grid.getBlocksInfo();
-    const int N = vInfo.size();
+    const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
     const BlockInfo * const ary = &vInfo.front();
+    
+    BlockSchedule schedule(vInfo, grid);
 
 #if (_OPENMP < 201107)   
+    const int N = vInfo.size();
+    
     Real * tmp = NULL;
     int error = posix_memalign((void**)&tmp, std::max(8, _ALIGNBYTES_), sizeof(Real) * N);
     assert(error == 0);
@@ -162,19 +451,15 @@ Real _computeSOS_OMP(FluidGrid& grid,  bool bAwk)
 	
 #pragma omp parallel
     {
-        
-#ifdef _USE_NUMA_
-		const int cores_per_node = numa_num_configured_cpus() / numa_num_configured_nodes();
-        const int mynode = omp_get_thread_num() / cores_per_node;
-        numa_run_on_node(mynode);
-#endif
+        NUMAPartition::bind();
         
         TSOS kernel;
-#pragma omp for schedule(runtime)
-        for (int i=0; i<N; ++i)
+        SOSBuffer buffer;
+        
+        for (int i=schedule.next(); i>=0; i=schedule.next())
         {
             FluidBlock & block = *(FluidBlock *)ary[i].ptrBlock;
-            local_sos[i] =  kernel.compute(&block.data[0][0][0].rho, FluidBlock::gptfloats);
+            local_sos[i] =  _sos(kernel, block, buffer.aos);
         }
     }
 	
@@ -244,14 +529,21 @@ Real _computeSOS_OMP(FluidGrid& grid,  bool bAwk)
 
 #pragma omp parallel
     {
-      TSOS kernel;
+        NUMAPartition::bind();
+        
+        TSOS kernel;
+        SOSBuffer buffer;
         Real mymax = 0;
 
-#pragma omp for schedule(runtime) reduction(max:global_sos)
-        for (size_t i=0; i<N; ++i)
+        for (int i=schedule.next(); i>=0; i=schedule.next())
         {
             FluidBlock & block = *(FluidBlock *)ary[i].ptrBlock;
-            global_sos =  kernel.compute(&block.data[0][0][0].rho, FluidBlock::gptfloats);
+            mymax = max(mymax, _sos(kernel, block, buffer.aos));
+        }
+        
+#pragma omp critical
+        {
+            global_sos = max(global_sos, mymax);
         }
     }
 
@@ -265,10 +557,19 @@ Real _computeSOS_OMP(FluidGrid& grid,  bool bAwk)
 
 Real FlowStep_LSRK3::_computeSOS(bool bAwk)
 {
+    //the last update of the previous step already computed it
+    if (nextSOS >= 0)
+    {
+        const Real sos = nextSOS;
+        nextSOS = -1;
+        
+        return sos;
+    }
+    
     Real sos = -1;
 	
     const string kernels = parser("-kernels").asString("cpp");
-    vector<BlockInfo> vInfo = grid.getBlocksInfo();
+    const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
     
 	Timer timer;
     
@@ -277,6 +578,11 @@ Real FlowStep_LSRK3::_computeSOS(bool bAwk)
 	if (kernels == "qpx")
 		sos = _computeSOS_OMP<MaxSpeedOfSound_QPX>(grid,  bAwk);
 	else
+#endif
+#ifdef _AVX_
+	if (kernels == "avx")
+		sos = _computeSOS_OMP<MaxSpeedOfSound_AVX>(grid,  bAwk);
+	else
 #endif
 		sos = _computeSOS_OMP<MaxSpeedOfSound_CPP>(grid,  bAwk);
 	
@@ -295,6 +601,9 @@ Real FlowStep_LSRK3::_computeSOS(bool bAwk)
 template<typename Kflow, typename Kupdate>
 struct LSRKstep
 {
+    //max characteristic speed of the grid after the step
+    Real maxsos;
+    
     template<typename T>
     void check_error(const double tol, T ref[], T val[], const int N)
     {
@@ -350,7 +659,7 @@ struct LSRKstep
     
     void _check_symmetry(FluidGrid& grid)
     {
-        vector<BlockInfo> vInfo = grid.getBlocksInfo();
+        const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
         
         for(int i=0; i<(int)vInfo.size(); i++)
         {
@@ -373,7 +682,9 @@ struct LSRKstep
                     {
                         const int idx_mirror[3] = {ix, FluidBlock::sizeY-iy-1, iz};
                         
-                        check_error(std::numeric_limits<Real>::epsilon()*50, &b(ix,iy,iz).rho, &b_mirror(idx_mirror[0],idx_mirror[1],idx_mirror[2]).rho, 7, bidx_mirror, idx_mirror, 0);
+                        const FluidElement e = b(ix,iy,iz), e_mirror = b_mirror(idx_mirror[0],idx_mirror[1],idx_mirror[2]);
+                        
+                        check_error(std::numeric_limits<Real>::epsilon()*50, &e.rho, &e_mirror.rho, 7, bidx_mirror, idx_mirror, 0);
 //                        check_error(std::numeric_limits<Real>::epsilon()*50, &b.tmp[iz][iy][ix][0], &b_mirror.tmp[idx_mirror[2]][idx_mirror[1]][idx_mirror[0]][0], 7, bidx_mirror, idx_mirror, 1);
                     }
         }
@@ -383,14 +694,43 @@ struct LSRKstep
     
     LSRKstep(FluidGrid& grid, Real dtinvh, const Real current_time, bool bAwk)
     {
-        vector<BlockInfo> vInfo = grid.getBlocksInfo();
+        const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
         
         vector< vector<double> > timings;
 
-        //_check_symmetry(grid);
-        timings.push_back(step(grid, vInfo, 0      , 1./4, dtinvh, current_time));
-        timings.push_back(step(grid, vInfo, -17./32, 8./9, dtinvh, current_time));
-        timings.push_back(step(grid, vInfo, -32./27, 3./4, dtinvh, current_time));
+        if (LSRK3data::wavefront)
+        {
+            //the three substeps in one go, the flowstep time includes the updates
+            const Real a[3] = {0, -17./32, -32./27};
+            const Real b[3] = {1./4, 8./9, 3./4};
+            
+            Timer timer;
+            timer.start();
+            if (LSRK3data::lab == "soa")
+                maxsos = _wavefront<BlockLabSOA<Lab>, Kflow, Kupdate>(a, b, dtinvh, vInfo, grid, true, current_time);
+            else if (LSRK3data::lab == "halo")
+                maxsos = _wavefront<BlockLabHalo<Lab>, Kflow, Kupdate>(a, b, dtinvh, vInfo, grid, true, current_time);
+            else
+                maxsos = _wavefront<Lab, Kflow, Kupdate>(a, b, dtinvh, vInfo, grid, true, current_time);
+            const double t = timer.stop();
+            
+            timings.resize(3, vector<double>(2, 0));
+            timings[0][0] = timings[1][0] = timings[2][0] = t/3;
+        }
+        else
+        {
+            //the readers of the blocks do not change across the substeps
+            LSRK3data::FusedUpdate<Kupdate> * fused = NULL;
+            if (LSRK3data::fused)
+                fused = new LSRK3data::FusedUpdate<Kupdate>(vInfo, grid, false);
+
+            //_check_symmetry(grid);
+            timings.push_back(step(grid, vInfo, 0      , 1./4, dtinvh, current_time, fused));
+            timings.push_back(step(grid, vInfo, -17./32, 8./9, dtinvh, current_time, fused));
+            timings.push_back(step(grid, vInfo, -32./27, 3./4, dtinvh, current_time, fused, &maxsos));
+        
+            delete fused;
+        }
         
         const double avg1 = ( timings[0][0] + timings[1][0] + timings[2][0] )/3;
         const double avg2 = ( timings[0][1] + timings[1][1] + timings[2][1] )/3;
@@ -401,33 +741,57 @@ struct LSRKstep
             cout << "UPDATE: " << avg2 << "s (per substep), " << avg2/vInfo.size()*1e3 << " ms (per block)" << endl;
 			//const float PEAKPERF_CORE, const float PEAKBAND, const int NCORES, const int NTIMES, const int NBLOCKS, const float MEASUREDTIME            
             Kflow::printflops(LSRK3data::PEAKPERF_CORE*1e9, LSRK3data::PEAKBAND*1e9, LSRK3data::NCORES, 1, vInfo.size(), avg1);
-            Kupdate::printflops(LSRK3data::PEAKPERF_CORE*1e9, LSRK3data::PEAKBAND*1e9, LSRK3data::NCORES, 1, vInfo.size(), avg2);
+            
+            //with -fused 1 or -wavefront 1 the update is timed within the flowstep
+            if (!LSRK3data::fused && !LSRK3data::wavefront)
+                Kupdate::printflops(LSRK3data::PEAKPERF_CORE*1e9, LSRK3data::PEAKBAND*1e9, LSRK3data::NCORES, 1, vInfo.size(), avg2);
         }
     }
     
-    vector<double> step(FluidGrid& grid, vector<BlockInfo>& vInfo, Real a, Real b, Real dtinvh, const Real current_time)
+    //maxsos != NULL: the update also computes the max characteristic speed of the new state
+    static vector<double> step(FluidGrid& grid, const vector<BlockInfo>& vInfo, Real a, Real b, Real dtinvh, const Real current_time, LSRK3data::FusedUpdate<Kupdate> * const fused, Real * const maxsos=NULL)
     {
         Timer timer;
         vector<double> res;
         
         LSRK3data::FlowStep<Kflow, Lab> rhs(a, dtinvh);
+        LSRK3data::Update<Kupdate> update(b, &vInfo.front());
+        
+        if (fused) fused->reset(update, maxsos != NULL);
 	
 #ifdef _USE_HPM_
 	HPM_Start("RHS");	
 #endif
         timer.start();     
-        _process<Lab, Kflow>(a, dtinvh, vInfo, grid, current_time);
+        if (LSRK3data::lab == "soa")
+            _process<BlockLabSOA<Lab>, Kflow>(a, dtinvh, vInfo, grid, fused, current_time);
+        else if (LSRK3data::lab == "halo")
+            _process<BlockLabHalo<Lab>, Kflow>(a, dtinvh, vInfo, grid, fused, current_time);
+        else
+            _process<Lab, Kflow>(a, dtinvh, vInfo, grid, fused, current_time);
         const double t1 = timer.stop();
 #ifdef _USE_HPM_
         HPM_Stop("RHS");
 #endif
-        LSRK3data::Update<Kupdate> update(b, &vInfo.front());
         
 #ifdef _USE_HPM_
 	HPM_Start("Update");
 #endif
         timer.start();
-        update.omp(vInfo.size());
+        if (fused)
+        {
+            assert(fused->complete());
+            
+            if (maxsos) *maxsos = fused->maxsos();
+        }
+        else
+        {
+            BlockSchedule schedule(vInfo, grid);
+            
+            const Real sos = update.omp(schedule, maxsos != NULL);
+            
+            if (maxsos) *maxsos = sos;
+        }
         const double t2 = timer.stop();
 #ifdef _USE_HPM_
         HPM_Stop("Update");
@@ -452,6 +816,31 @@ void FlowStep_LSRK3::set_constants()
     LSRK3data::pc2 = pc2;
     LSRK3data::dispatcher = blockdispatcher;
     LSRK3data::ReportFreq = parser("-report").asInt(20);
+    LSRK3data::lab = parser("-lab").asString("aos");
+    LSRK3data::fused = parser("-fused").asBool(false);
+    LSRK3data::wavefront = parser("-wavefront").asBool(false);
+    LSRK3data::quiescent = parser("-quiescent").asBool(false);
+}
+
+void FlowStep_LSRK3::substep(const Real a, const Real b, const Real dtinvh)
+{
+    const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
+    
+    if (parser("-kernels").asString("cpp")=="cpp")
+        LSRKstep<Convection_CPP, Update_CPP>::step(grid, vInfo, a, b, dtinvh, current_time, NULL);
+#if defined(_QPX_) || defined(_QPXEMU_)    
+    else if (parser("-kernels").asString("cpp")=="qpx")
+        LSRKstep<Convection_QPX, Update_QPX>::step(grid, vInfo, a, b, dtinvh, current_time, NULL);
+#endif
+#ifdef _AVX_
+    else if (parser("-kernels").asString("cpp")=="avx")
+        LSRKstep<Convection_AVX, Update_AVX>::step(grid, vInfo, a, b, dtinvh, current_time, NULL);
+#endif
+    else
+    {
+        cout << "combination not supported yet" << endl;
+        abort();
+    }
 }
 
 Real FlowStep_LSRK3::operator()(const Real max_dt)
@@ -493,10 +882,14 @@ Real FlowStep_LSRK3::operator()(const Real max_dt)
         cout << "Dispatcher is " << LSRK3data::dispatcher << endl;
     
     if (parser("-kernels").asString("cpp")=="cpp")
-        LSRKstep<Convection_CPP, Update_CPP>(grid, dt/h, current_time, bAwk);
+        nextSOS = LSRKstep<Convection_CPP, Update_CPP>(grid, dt/h, current_time, bAwk).maxsos;
 #if defined(_QPX_) || defined(_QPXEMU_)    
 	else if (parser("-kernels").asString("cpp")=="qpx")
-		LSRKstep<Convection_QPX, Update_QPX>(grid, dt/h, current_time, bAwk);
+		nextSOS = LSRKstep<Convection_QPX, Update_QPX>(grid, dt/h, current_time, bAwk).maxsos;
+#endif
+#ifdef _AVX_
+	else if (parser("-kernels").asString("cpp")=="avx")
+		nextSOS = LSRKstep<Convection_AVX, Update_AVX>(grid, dt/h, current_time, bAwk).maxsos;
 #endif
     else
     {
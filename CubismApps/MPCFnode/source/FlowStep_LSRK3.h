@@ -8,7 +8,12 @@
  */
 #pragma once
 
+#include <map>
+#include <set>
+#include <algorithm>
+
 #include <StencilInfo.h>
+#include <BlockSchedule.h>
 
 #ifdef _USE_NUMA_
 #include <numa.h>
@@ -28,6 +33,10 @@ namespace LSRK3data
     extern Real pc1;
     extern Real pc2 ;
 	extern string dispatcher;
+	extern string lab;
+	extern bool fused;
+	extern bool wavefront;
+	extern bool quiescent;
 	extern int step_id;
 	extern int ReportFreq;
     
@@ -71,31 +80,289 @@ namespace LSRK3data
 	struct Update
 	{
 		Real b;
-		BlockInfo * ary;
+		const BlockInfo * ary;
 		
 	public:
 		
-		Update(float b, BlockInfo * ary): b(b), ary(ary) { }
+		Update(float b, const BlockInfo * ary): b(b), ary(ary) { }
 		Update(const Update& c): b(c.b), ary(c.ary) { } 
+		Update& operator=(const Update& c) { b = c.b; ary = c.ary; return *this; }
+		
+		//data += b * tmp for one block. the update kernels work on AoS points:
+		//with another layout, tmp (always AoS) is added to data quantity by quantity
+		void operator()(const Kernel& kernel, FluidBlock& block) const
+		{
+#if _LAYOUT_AOS_
+			kernel.compute(&block.tmp[0][0][0][0], &block.data[0][0][0].rho, block.gptfloats);
+#else
+			const Real * const src = &block.tmp[0][0][0][0];
+			
+			for(int c=0; c<FluidBlock::NCOMPONENTS; ++c)
+				for(int ip=0; ip<FluidBlock::NPOINTS; ++ip)
+					block.data[FluidBlock::offset(ip, c)] += b * src[FluidBlock::gptfloats * ip + c];
+#endif
+		}
+		
+		//same as above, it returns the max characteristic speed of the updated block.
+		//with another layout, the new state is copied into tmp (no longer needed) for Kernel::SOSKernel
+		Real maxsos(const Kernel& kernel, FluidBlock& block) const
+		{
+#if _LAYOUT_AOS_
+			return kernel.compute_maxsos(&block.tmp[0][0][0][0], &block.data[0][0][0].rho, block.gptfloats);
+#else
+			Real * const tmp = &block.tmp[0][0][0][0];
+			
+			for(int c=0; c<FluidBlock::NCOMPONENTS; ++c)
+				for(int ip=0; ip<FluidBlock::NPOINTS; ++ip)
+					tmp[FluidBlock::gptfloats * ip + c] = block.data[FluidBlock::offset(ip, c)] += b * tmp[FluidBlock::gptfloats * ip + c];
+			
+			return typename Kernel::SOSKernel().compute(tmp, FluidBlock::gptfloats);
+#endif
+		}
 	    
-		void omp(const int N)
+		//the max characteristic speed of a block that is not updated (FluidBlock::quiescent).
+		//with another layout, the state is copied into tmp as in maxsos()
+		Real maxsos_quiescent(FluidBlock& block) const
 		{
+#if _LAYOUT_AOS_
+			return typename Kernel::SOSKernel().compute(&block.data[0][0][0].rho, block.gptfloats);
+#else
+			Real * const tmp = &block.tmp[0][0][0][0];
+			
+			for(int c=0; c<FluidBlock::NCOMPONENTS; ++c)
+				for(int ip=0; ip<FluidBlock::NPOINTS; ++ip)
+					tmp[FluidBlock::gptfloats * ip + c] = block.data[FluidBlock::offset(ip, c)];
+			
+			return typename Kernel::SOSKernel().compute(tmp, FluidBlock::gptfloats);
+#endif
+		}
+		
+		//with sos, it returns the max characteristic speed of the new state.
+		//the items of schedule are the blocks of ary, the quiescent ones are left as they are
+		Real omp(BlockSchedule& schedule, const bool sos=false)
+		{
+			Real global_sos = 0;
+			
 #pragma omp parallel
 			{
-#ifdef _USE_NUMA_
-				const int cores_per_node = numa_num_configured_cpus() / numa_num_configured_nodes();
-                const int mynode = omp_get_thread_num() / cores_per_node;
-                numa_run_on_node(mynode);
-#endif
+                NUMAPartition::bind();
+                
                 Kernel kernel(b);
+                Real mymax = 0;
                 
-#pragma omp for schedule(runtime)
-                for(int r=0; r<N; ++r)
+                for(int r=schedule.next(); r>=0; r=schedule.next())
                 {
-                    FluidBlock & block = *(FluidBlock *)ary[r].ptrBlock;
-                    kernel.compute(&block.tmp[0][0][0][0], &block.data[0][0][0].rho, block.gptfloats);
+                    FluidBlock& block = *(FluidBlock *)ary[r].ptrBlock;
+                    
+                    if (block.quiescent)
+                    {
+                        if (sos) mymax = max(mymax, maxsos_quiescent(block));
+                    }
+                    else if (sos)
+                        mymax = max(mymax, maxsos(kernel, block));
+                    else
+                        (*this)(kernel, block);
+                }
+                
+#pragma omp critical
+                {
+                    global_sos = max(global_sos, mymax);
                 }
 			}
+			
+			return global_sos;
+		}
+	};
+	
+	//-quiescent 1: the RHS of a block is exactly zero if the block and the ghosts read by the
+	//kernels, i.e. its face neighbors, all hold one and the same state (e.g. ahead of a shock).
+	//such a block is quiescent: its lab is not loaded, its RHS is not computed and its update
+	//is skipped, its tmp being zero. the blocks on the boundary of the domain (boundary conditions)
+	//or next to another rank are always computed. not used with -fused 1 or -wavefront 1
+	
+	//FluidBlock::uniform of the blocks, to be set before each RHS sweep
+	template<typename TGrid>
+	void mark_uniform(const vector<BlockInfo>& vInfo, TGrid& grid)
+	{
+		BlockSchedule schedule(vInfo, grid);
+		
+#pragma omp parallel
+		{
+			NUMAPartition::bind();
+			
+			for(int i=schedule.next(); i>=0; i=schedule.next())
+			{
+				FluidBlock& b = *(FluidBlock *)vInfo[i].ptrBlock;
+				
+				b.uniform = b.isuniform();
+			}
+		}
+	}
+	
+	//true if the block is quiescent: it is marked as such and its RHS is not to be computed.
+	//a block computed at the previous substep is skipped only if a = 0, otherwise its tmp still
+	//holds a*tmp to be added by the update. the tmp of a block that was quiescent at the previous
+	//substep and is computed again is zeroed, as the kernel reads it (unless a = 0)
+	template<typename TGrid>
+	bool skip(const BlockInfo& info, TGrid& grid, const Real a)
+	{
+		FluidBlock& b = *(FluidBlock *)info.ptrBlock;
+		const int * const idx = info.index;
+		
+		bool retval = b.uniform && (a == 0 || b.quiescent);
+		
+		for(int d=0; d<3 && retval; ++d)
+			retval = idx[d] > 0 && idx[d] < grid.getBlocksPerDimension(d) - 1;
+		
+		for(int f=0; f<6 && retval; ++f)
+		{
+			const int dx = f == 0 ? -1 : f == 1 ? 1 : 0;
+			const int dy = f == 2 ? -1 : f == 3 ? 1 : 0;
+			const int dz = f == 4 ? -1 : f == 5 ? 1 : 0;
+			
+			retval = grid.avail(idx[0] + dx, idx[1] + dy, idx[2] + dz);
+			
+			if (retval)
+			{
+				const FluidBlock& n = grid(idx[0] + dx, idx[1] + dy, idx[2] + dz);
+				
+				retval = n.uniform && b.samestate(n);
+			}
+		}
+		
+		if (!retval && b.quiescent && a != 0) b.clear_tmp();
+		
+		b.quiescent = retval;
+		
+		return retval;
+	}
+	
+	//the blocks read by the lab of block i, i included: readers[start[i]..start[i+1]-1].
+	//they are also the blocks whose lab reads block i
+	struct Readers
+	{
+		map<void *, int> ids;
+		vector<int> start, readers;
+		
+		//the labs load the face neighbors, and also edges and corners if tensorial.
+		//the neighbors owned by another rank are not tracked: their labs read a copy of the block
+		template<typename TGrid>
+		Readers(const vector<BlockInfo>& vInfo, TGrid& grid, const bool tensorial)
+		{
+			const int N = vInfo.size();
+			
+			for(int i=0; i<N; ++i)
+				ids[vInfo[i].ptrBlock] = i;
+			
+			start.push_back(0);
+			
+			for(int i=0; i<N; ++i)
+			{
+				const int * const idx = vInfo[i].index;
+				set<int> mine;
+				
+				for(int dz=-1; dz<2; ++dz)
+					for(int dy=-1; dy<2; ++dy)
+						for(int dx=-1; dx<2; ++dx)
+						{
+							if (!tensorial && abs(dx) + abs(dy) + abs(dz) > 1) continue;
+							if (!grid.avail(idx[0] + dx, idx[1] + dy, idx[2] + dz)) continue;
+							
+							mine.insert(ids[(void *)&grid(idx[0] + dx, idx[1] + dy, idx[2] + dz)]);
+						}
+				
+				readers.insert(readers.end(), mine.begin(), mine.end());
+				start.push_back(readers.size());
+			}
+		}
+		
+		int size() const { return (int)start.size() - 1; }
+		
+		int count(const int i) const { return start[i+1] - start[i]; }
+	};
+	
+	//counter - 1, the counter being shared by the threads
+	inline int decrement(int& counter)
+	{
+		int left;
+		
+#if _OPENMP >= 201107
+#pragma omp atomic capture
+		left = --counter;
+#else
+#pragma omp critical(lsrk3decrement)
+		left = --counter;
+#endif
+		return left;
+	}
+	
+	//-fused 1: the update is not a sweep of its own. the update of a block is run by the
+	//thread completing the last RHS that reads the block (its own or the one of a neighbor),
+	//while data and tmp are still in cache
+	template < typename Kernel >
+	class FusedUpdate
+	{
+		Update<Kernel> update;
+		
+		Readers readers;
+		vector<int> pending;		//RHS still to be computed that read block i
+		
+		bool sos;
+		vector<Real> blocksos;		//max characteristic speed of block i after its update, if sos
+		
+	public:
+		
+		template<typename TGrid>
+		FusedUpdate(const vector<BlockInfo>& vInfo, TGrid& grid, const bool tensorial):
+		update(0, NULL), readers(vInfo, grid, tensorial), pending(vInfo.size()), sos(false), blocksos(vInfo.size())
+		{
+		}
+		
+		//to be called before the RHS sweep, update.ary being &vInfo.front()
+		void reset(const Update<Kernel>& update, const bool sos=false)
+		{
+			this->update = update;
+			this->sos = sos;
+			
+			const int N = pending.size();
+			
+			for(int i=0; i<N; ++i)
+				pending[i] = readers.count(i);
+		}
+		
+		//the RHS of the i-th block is done
+		void done(const int i)
+		{
+			const Kernel kernel(update.b);
+			
+#pragma omp flush
+			for(int k=readers.start[i]; k<readers.start[i+1]; ++k)
+			{
+				const int j = readers.readers[k];
+				
+				if (decrement(pending[j]) == 0)
+				{
+#pragma omp flush
+					if (sos)
+						blocksos[j] = update.maxsos(kernel, *(FluidBlock *)update.ary[j].ptrBlock);
+					else
+						update(kernel, *(FluidBlock *)update.ary[j].ptrBlock);
+				}
+			}
+		}
+		
+		void done(const BlockInfo& info) { done(readers.ids.find(info.ptrBlock)->second); }
+		
+		//after the RHS sweep
+		bool complete() const
+		{
+			return count(pending.begin(), pending.end(), 0) == (int)pending.size();
+		}
+		
+		//after the RHS sweep, if reset with sos
+		Real maxsos() const
+		{
+			return blocksos.empty() ? 0 : *max_element(blocksos.begin(), blocksos.end());
 		}
 	};
 }
@@ -118,6 +385,9 @@ protected:
     
     bool bAwk;
     
+    //max characteristic speed of the grid, computed by the last update of the previous step. -1 if not known
+    Real nextSOS;
+    
     Real _computeSOS(bool bAwk=false);
     
     ArgumentParser parser;
@@ -127,7 +397,7 @@ public:
     Real CFL;
     
     FlowStep_LSRK3(FluidGrid& grid, const Real CFL, const Real gamma1, const Real gamma2, ArgumentParser& parser, const int verbosity=1, Profiler* profiler=NULL, const Real pc1=0, const Real pc2=0, const bool bAwk=false):
-    grid(grid), CFL(CFL), gamma1(gamma1), gamma2(gamma2), parser(parser), verbosity(verbosity), profiler(profiler), pc1(pc1), pc2(pc2), bAwk(bAwk) 
+    grid(grid), CFL(CFL), gamma1(gamma1), gamma2(gamma2), parser(parser), verbosity(verbosity), profiler(profiler), pc1(pc1), pc2(pc2), bAwk(bAwk), nextSOS(-1)
     {
         parser.unset_strict_mode();
         
@@ -135,7 +405,7 @@ public:
         PEAKBAND = parser("-pb").asDouble(19);
         blockdispatcher = parser("-dispatcher").asString("");
         
-        vector<BlockInfo> vInfo = grid.getBlocksInfo();
+        const vector<BlockInfo>& vInfo = grid.getBlocksInfo();
         h = vInfo[0].h_gridpoint;
         smoothlength = (Real)(parser("-mollfactor").asInt())*sqrt(3.)*h;
         Simulation_Environment::EPSILON = smoothlength;
@@ -148,4 +418,10 @@ public:
     void set_constants();
     
     void set_CFL(const Real _CFL) {CFL = _CFL;}
+    
+    //to be called if the grid is modified between two steps
+    void invalidate_sos() {nextSOS = -1;}
+    
+    //one RHS sweep and update with the coefficients a, b of a substep, after set_constants()
+    void substep(const Real a, const Real b, const Real dtinvh);
 };
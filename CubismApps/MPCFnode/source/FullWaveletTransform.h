@@ -14,7 +14,10 @@
 #include <bitset>
 
 #include "WaveletsOnInterval.h"
-#if defined(_QPX_) || defined(_QPXEMU_)
+
+//the QPX wavelets operate on 4 floats: the double-precision emulation uses the C++ sweeps
+#if defined(_QPX_) || (defined(_QPXEMU_) && defined(_FLOAT_PRECISION_))
+#define _QPXWAVELETS_
 #include "WaveletsOnIntervalQPX.h"
 #endif
 using namespace std;
@@ -35,7 +38,7 @@ namespace WaveletsOnInterval
 	inline const char * ChosenWavelets_GetName() { return _name<ChosenWavelets>(); }
 
 	template<int BS, int ROWSIZE, int COLSIZE, int SLICESIZE, bool lifting>
-#if defined(_QPX_) || defined(_QPXEMU_)
+#ifdef _QPXWAVELETS_
 	struct FullTransformEngine : WaveletSweepQPX< ROWSIZE, COLSIZE>
 #else
 	struct FullTransformEngine : WaveletSweep< ChosenWavelets, ROWSIZE, COLSIZE>
@@ -341,6 +341,8 @@ void Test_Cloud::setup()
     
   if (parser("-morton").asBool(0))
     grid = new GridMorton<FluidGrid>(BPDX, BPDY, BPDZ);
+  else if (parser("-hilbert").asBool(0))
+    grid = new GridHilbert<FluidGrid>(BPDX, BPDY, BPDZ);
   else
     grid = new FluidGrid(BPDX, BPDY, BPDZ);
     
@@ -363,4 +365,6 @@ void Test_Cloud::setup()
       //_my_ic(*grid, my_seed.get_vshapes());
       _my_ic_quad(*grid, my_seed);
   }
+  
+  stepper->invalidate_sos();
 }
@@ -0,0 +1,94 @@
+/*
+ *  Test_Quiescent.cpp
+ *  MPCFnode
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "Test_Quiescent.h"
+
+void Test_Quiescent::setup()
+{
+	_setup_constants();
+
+	//the center block has to be away from the boundaries of the domain
+	grid = new FluidGrid(max(3, BPDX), max(3, BPDY), max(3, BPDZ));
+
+	assert(grid != NULL);
+
+	stepper = new FlowStep_LSRK3(*grid, CFL, Simulation_Environment::GAMMA1, Simulation_Environment::GAMMA2, parser, VERBOSITY);
+}
+
+const BlockInfo& Test_Quiescent::_center() const
+{
+	const vector<BlockInfo>& vInfo = grid->getBlocksInfo();
+
+	int i = 0;
+	while (vInfo[i].index[0] != grid->getBlocksPerDimension(0) / 2 ||
+		   vInfo[i].index[1] != grid->getBlocksPerDimension(1) / 2 ||
+		   vInfo[i].index[2] != grid->getBlocksPerDimension(2) / 2) i++;
+
+	return vInfo[i];
+}
+
+//bQuiescent: the state seen with -quiescent 1, where a block left as quiescent keeps the tmp
+//of an earlier substep, otherwise its tmp is zero
+void Test_Quiescent::_state(const bool bQuiescent, const bool bWasQuiescent)
+{
+	const vector<BlockInfo>& vInfo = grid->getBlocksInfo();
+
+	//the padding of the points is not set by the initial condition
+	for(int i=0; i<(int)vInfo.size(); i++)
+		((FluidBlock *)vInfo[i].ptrBlock)->clear();
+
+	Test_SteadyState::_ic(*grid);
+
+	FluidBlock& c = *(FluidBlock *)_center().ptrBlock;
+
+	if (!bWasQuiescent || bQuiescent)
+	{
+		const int N = FluidBlock::sizeX * FluidBlock::sizeY * FluidBlock::sizeZ * FluidBlock::gptfloats;
+
+		Real * const t = &c.tmp[0][0][0][0];
+		for(int i=0; i<N; ++i)
+			t[i] = 1e-3 * (1 + i % 7);
+	}
+
+	c.quiescent = bWasQuiescent && bQuiescent;
+}
+
+//the state of the center block after the second substep
+vector<Real> Test_Quiescent::_substep(const bool bQuiescent, const bool bWasQuiescent)
+{
+	_state(bQuiescent, bWasQuiescent);
+
+	stepper->set_constants();
+	LSRK3data::quiescent = bQuiescent;
+
+	//the RHS of the center block is zero, the time step does not matter
+	stepper->substep(-17./32, 8./9, 1);
+
+	const FluidBlock& c = *(FluidBlock *)_center().ptrBlock;
+	const Real * const d = (const Real *)c.data;
+
+	return vector<Real>(d, d + sizeof(c.data) / sizeof(Real));
+}
+
+void Test_Quiescent::run()
+{
+	const char * const previous[2] = { "computed", "quiescent" };
+
+	for(int i=0; i<2; i++)
+	{
+		const vector<Real> ref = _substep(false, i == 1);
+		const vector<Real> res = _substep(true, i == 1);
+
+		const bool passed = ref == res;
+
+		printf("QUIESCENT TEST, block %s at the previous substep: %s\n", previous[i], passed ? "passed" : "FAILED");
+
+		if (!passed) abort();
+	}
+}
@@ -0,0 +1,26 @@
+/*
+ *  Test_Quiescent.h
+ *  MPCFnode
+ *
+ */
+#pragma once
+
+#include "Test_SteadyState.h"
+
+//-sim quiescent: one substep of a steady state, with and without -quiescent 1, must give the
+//same state. the block at the center of the grid is uniform and equal to its neighbors,
+//its tmp is that of a block computed at the previous substep or left as quiescent
+class Test_Quiescent: public Test_SteadyState
+{
+	const BlockInfo& _center() const;
+
+	void _state(const bool bQuiescent, const bool bWasQuiescent);
+	vector<Real> _substep(const bool bQuiescent, const bool bWasQuiescent);
+
+public:
+
+	Test_Quiescent(const int argc, const char ** argv): Test_SteadyState(argc, argv) { }
+
+	void setup();
+	void run();
+};
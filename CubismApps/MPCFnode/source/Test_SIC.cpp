@@ -132,6 +132,8 @@ void Test_SIC::setup()
     
     if (parser("-morton").asBool(0))
         grid = new GridMorton<FluidGrid>(BPDX, BPDY, BPDZ);
+    else if (parser("-hilbert").asBool(0))
+        grid = new GridHilbert<FluidGrid>(BPDX, BPDY, BPDZ);
     else
         grid = new FluidGrid(BPDX, BPDY, BPDZ);
     
@@ -146,4 +148,6 @@ void Test_SIC::setup()
     }
     else
         _ic(*grid);
+    
+    stepper->invalidate_sos();
 }
@@ -358,6 +358,8 @@ void Test_ShockBubble::setup()
 	
 	if (parser("-morton").asBool(0))
 		grid = new GridMorton<FluidGrid>(BPDX, BPDY, BPDZ);
+	else if (parser("-hilbert").asBool(0))
+		grid = new GridHilbert<FluidGrid>(BPDX, BPDY, BPDZ);
 	else
 		grid = new FluidGrid(BPDX, BPDY, BPDZ);
 	
@@ -372,4 +374,6 @@ void Test_ShockBubble::setup()
 	}
 	else
 		_ic(*grid);
+	
+	stepper->invalidate_sos();
 }
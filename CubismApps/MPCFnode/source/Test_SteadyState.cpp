@@ -229,7 +229,13 @@ void Test_SteadyState::setup()
 		printf("////////////////////////////////////////////////////////////\n");
 	}
     
-	grid = new FluidGrid(BPDX, BPDY, BPDZ);
+	//block orderings, to be benchmarked against each other
+	if (parser("-morton").asBool(0))
+		grid = new GridMorton<FluidGrid>(BPDX, BPDY, BPDZ);
+	else if (parser("-hilbert").asBool(0))
+		grid = new GridHilbert<FluidGrid>(BPDX, BPDY, BPDZ);
+	else
+		grid = new FluidGrid(BPDX, BPDY, BPDZ);
 	
 	assert(grid != NULL);
 	
@@ -245,4 +251,6 @@ void Test_SteadyState::setup()
 		_ic(*grid);
 		_dump("initialcondition");
 	}
+	
+	stepper->invalidate_sos();
 }
@@ -13,7 +13,7 @@
 
 #include "Test_ShockBubble.h"
 //typedef BlockLab<FluidBlock, std::allocator> Lab;
-typedef BlockLabBubble<FluidBlock, std::allocator> Lab;
+typedef BlockLabBubble<FluidBlock, BlockAllocator> Lab;
 
 //#include "Test_SIC.h"
 //maybe replace it with std::allocator
@@ -22,6 +22,7 @@ using namespace std;
 
 #include <Grid.h>
 #include <GridMorton.h>
+#include <GridHilbert.h>
 #include <BlockLab.h>
 //#include <BlockProcessing.h>
 #include <Profiler.h>
@@ -116,7 +117,10 @@ struct FluidElement
   Real rho, u, v, w, energy, G, P, dummy;
 
     void clear() { rho = u = v = w = energy = G = P = dummy = 0; }
-    
+
+    FluidElement() = default;
+    FluidElement(const FluidElement&) = default;
+
     FluidElement& operator = (const FluidElement & gp)
     {       
         this->rho = gp.rho;
@@ -248,6 +252,70 @@ struct StreamerG
 	}
 };
 
+//the quantities of a grid point when they are not contiguous in memory (layout=soa|aosoa):
+//it is what FluidBlock::operator() returns instead of a FluidElement&
+struct FluidElementRef
+{
+	Real &rho, &u, &v, &w, &energy, &G, &P;
+	
+	FluidElementRef(Real * const p, const int stride):
+	rho(p[0]), u(p[stride]), v(p[2*stride]), w(p[3*stride]), energy(p[4*stride]), G(p[5*stride]), P(p[6*stride]) { }
+	
+	operator FluidElement() const
+	{
+		FluidElement e;
+		
+		e.rho = rho;
+		e.u = u;
+		e.v = v;
+		e.w = w;
+		e.energy = energy;
+		e.G = G;
+		e.P = P;
+		e.dummy = 0;
+		
+		return e;
+	}
+	
+	void clear() { rho = u = v = w = energy = G = P = 0; }
+	
+	FluidElementRef& operator = (const FluidElement & gp)
+	{
+		rho = gp.rho;
+		u = gp.u;
+		v = gp.v;
+		w = gp.w;
+		energy = gp.energy;
+		G = gp.G;
+		P = gp.P;
+		
+		return *this;
+	}
+	
+	FluidElementRef& operator = (const FluidElementRef & gp) { return *this = (FluidElement)gp; }
+};
+
+//storage layout of FluidBlock::data, chosen at compile time (layout=aos|soa|aosoa):
+//AoS is the array of FluidElement (dummy included), SoA stores the 7 quantities one
+//after the other, AoSoA stores tiles of _LAYOUTTILE_ points along x quantity by quantity,
+//a tile being as wide as a SIMD register. tmp is always AoS: it is written by the kernels
+#if defined(_LAYOUT_SOA_) || defined(_LAYOUT_AOSOA_)
+#define _LAYOUT_AOS_ 0
+#else
+#define _LAYOUT_AOS_ 1
+#endif
+
+#ifdef _LAYOUT_AOSOA_
+#ifdef _FLOAT_PRECISION_
+#define _LAYOUTTILE_ (_ALIGNBYTES_ / 4)
+#else
+#define _LAYOUTTILE_ (_ALIGNBYTES_ / 8)
+#endif
+#if _BLOCKSIZE_ % _LAYOUTTILE_ != 0
+#error BLOCKSIZE NOT GOOD FOR AOSOA
+#endif
+#endif
+
 struct FluidBlock
 {
 	static const int sizeX = _BLOCKSIZE_;
@@ -259,15 +327,57 @@ struct FluidBlock
 	typedef FluidElement ElementType;
 	typedef FluidElement element_type;
 	
+	enum { NPOINTS = _BLOCKSIZE_ * _BLOCKSIZE_ * _BLOCKSIZE_ };
+	
+	//see BlockLayout.h
+#if _LAYOUT_AOS_
+	enum { NCOMPONENTS = gptfloats, TILE = 1, TILEFLOATS = gptfloats, POINTFLOATS = 0, COMPFLOATS = 1 };
+	
+	typedef FluidElement& ElementRef;
+	typedef const FluidElement& ConstElementRef;
+	
 	FluidElement __attribute__((__aligned__(_ALIGNBYTES_))) data[_BLOCKSIZE_][_BLOCKSIZE_][_BLOCKSIZE_];
+#else
+#ifdef _LAYOUT_SOA_
+	enum { NCOMPONENTS = 7, TILE = NPOINTS, TILEFLOATS = 0, POINTFLOATS = 1, COMPFLOATS = NPOINTS };
+#else
+	enum { NCOMPONENTS = 7, TILE = _LAYOUTTILE_, TILEFLOATS = _LAYOUTTILE_ * 7, POINTFLOATS = 1, COMPFLOATS = _LAYOUTTILE_ };
+#endif
+	
+	typedef FluidElementRef ElementRef;
+	typedef FluidElement ConstElementRef;
+	
+	Real __attribute__((__aligned__(_ALIGNBYTES_))) data[NPOINTS * NCOMPONENTS];
+#endif
     
 	Real __attribute__((__aligned__(_ALIGNBYTES_))) tmp[_BLOCKSIZE_][_BLOCKSIZE_][_BLOCKSIZE_][gptfloats];
+	
+	//see LSRK3data::quiescent: all the points hold the same state (set before each RHS sweep),
+	//the RHS of the block was not computed at the last substep, its tmp being zero
+	bool uniform, quiescent;
+	
+	static BlockLayout layout()
+	{
+		const BlockLayout retval = {TILE, TILEFLOATS, POINTFLOATS, COMPFLOATS};
+		
+		return retval;
+	}
+	
+	//offset in data of the quantity c of the point ip = ix + sizeX*(iy + sizeY*iz)
+	static inline int offset(const int ip, const int c)
+	{
+		return (ip / TILE) * TILEFLOATS + (ip % TILE) * POINTFLOATS + c * COMPFLOATS;
+	}
     
 	void clear_data()
 	{
+#if _LAYOUT_AOS_
 		const int N = sizeX*sizeY*sizeZ;
 		FluidElement * const e = &data[0][0][0];
 		for(int i=0; i<N; ++i) e[i].clear();
+#else
+		for(int i=0; i<NPOINTS * NCOMPONENTS; ++i) data[i] = 0;
+#endif
 	}
     
 	void clear_tmp()
@@ -282,8 +392,38 @@ struct FluidBlock
 	{
 		clear_data();
 		clear_tmp();
+		
+		uniform = quiescent = false;
+	}
+	
+	//the 7 quantities of all the points are equal to those of the first point (no NaNs)
+	bool isuniform() const
+	{
+		const Real * const d = (const Real *)data;
+		
+		Real ref[7];
+		for(int c=0; c<7; ++c)
+			ref[c] = d[offset(0, c)];
+		
+		for(int ip=0; ip<NPOINTS; ++ip)
+			for(int c=0; c<7; ++c)
+				if (!(d[offset(ip, c)] == ref[c])) return false;
+		
+		return true;
+	}
+	
+	//the first points of the two blocks hold the same state
+	bool samestate(const FluidBlock& b) const
+	{
+		const Real * const d = (const Real *)data, * const e = (const Real *)b.data;
+		
+		for(int c=0; c<7; ++c)
+			if (!(d[offset(0, c)] == e[offset(0, c)])) return false;
+		
+		return true;
 	}
     
+#if _LAYOUT_AOS_
 	inline FluidElement& operator()(int ix, int iy=0, int iz=0)
 	{
 		assert(ix>=0 && ix<sizeX);
@@ -293,13 +433,37 @@ struct FluidBlock
 		return data[iz][iy][ix];
 	}
 	
+	inline const FluidElement& operator()(int ix, int iy=0, int iz=0) const
+	{
+		assert(ix>=0 && ix<sizeX);
+		assert(iy>=0 && iy<sizeY);
+		assert(iz>=0 && iz<sizeZ);
+		
+		return data[iz][iy][ix];
+	}
+#else
+	inline FluidElementRef operator()(int ix, int iy=0, int iz=0)
+	{
+		assert(ix>=0 && ix<sizeX);
+		assert(iy>=0 && iy<sizeY);
+		assert(iz>=0 && iz<sizeZ);
+		
+		return FluidElementRef(data + offset(ix + sizeX * (iy + sizeY * iz), 0), COMPFLOATS);
+	}
+	
+	inline FluidElement operator()(int ix, int iy=0, int iz=0) const
+	{
+		return const_cast<FluidBlock&>(*this)(ix, iy, iz);
+	}
+#endif
+	
 	template <typename Streamer>
 	inline void Write(ofstream& output, Streamer streamer) const
 	{
 		for(int iz=0; iz<sizeZ; iz++)
 			for(int iy=0; iy<sizeY; iy++)
 				for(int ix=0; ix<sizeX; ix++)
-					streamer.operate(data[iz][iy][ix], output);
+					streamer.operate((*this)(ix, iy, iz), output);
 	}
 	
 	template <typename Streamer>
@@ -308,7 +472,13 @@ struct FluidBlock
 		for(int iz=0; iz<sizeZ; iz++)
 			for(int iy=0; iy<sizeY; iy++)
 				for(int ix=0; ix<sizeX; ix++)
-					streamer.operate(input, data[iz][iy][ix]);
+				{
+					FluidElement e = (*this)(ix, iy, iz);
+					
+					streamer.operate(input, e);
+					
+					(*this)(ix, iy, iz) = e;
+				}
 	}
 	
 	template <typename Streamer>
@@ -316,8 +486,8 @@ struct FluidBlock
 	{
 		enum { NCHANNELS = Streamer::channels };
 				
-		streamer.operate(data[0][0][0], minval);
-		streamer.operate(data[0][0][0], maxval);
+		streamer.operate((*this)(0, 0, 0), minval);
+		streamer.operate((*this)(0, 0, 0), maxval);
 		
 		for(int iz=0; iz<sizeZ; iz++)
 			for(int iy=0; iy<sizeY; iy++)
@@ -325,7 +495,7 @@ struct FluidBlock
 				{
 					Real tmp[NCHANNELS];
 					
-					streamer.operate(data[iz][iy][ix], tmp);
+					streamer.operate((*this)(ix, iy, iz), tmp);
 					
 					for(int ic = 0; ic < NCHANNELS; ++ic)
 						minval[ic] = std::min(minval[ic], tmp[ic]);
@@ -336,6 +506,15 @@ struct FluidBlock
 	}
 };
 
+template<> struct BlockLayoutTraits<FluidBlock>
+{
+	static const bool aos = _LAYOUT_AOS_;
+	
+	static BlockLayout layout(const int) { return FluidBlock::layout(); }
+};
+
+//the files are written in AoS whatever the layout
+#if _LAYOUT_AOS_
 template <> inline void FluidBlock::Write<StreamerGridPoint>(ofstream& output, StreamerGridPoint streamer) const
 {
 	output.write((const char *)&data[0][0][0], sizeof(FluidElement)*sizeX*sizeY*sizeZ);
@@ -345,6 +524,33 @@ template <> inline void FluidBlock::Read<StreamerGridPoint>(ifstream& input, Str
 {
 	input.read((char *)&data[0][0][0], sizeof(FluidElement)*sizeX*sizeY*sizeZ);
 }
+#else
+template <> inline void FluidBlock::Write<StreamerGridPoint>(ofstream& output, StreamerGridPoint streamer) const
+{
+	for(int iz=0; iz<sizeZ; iz++)
+		for(int iy=0; iy<sizeY; iy++)
+			for(int ix=0; ix<sizeX; ix++)
+			{
+				const FluidElement e = (*this)(ix, iy, iz);
+				
+				output.write((const char *)&e, sizeof(FluidElement));
+			}
+}
+
+template <> inline void FluidBlock::Read<StreamerGridPoint>(ifstream& input, StreamerGridPoint streamer)
+{
+	for(int iz=0; iz<sizeZ; iz++)
+		for(int iy=0; iy<sizeY; iy++)
+			for(int ix=0; ix<sizeX; ix++)
+			{
+				FluidElement e;
+				
+				input.read((char *)&e, sizeof(FluidElement));
+				
+				(*this)(ix, iy, iz) = e;
+			}
+}
+#endif
 
 struct StreamerDummy_HDF5 
 {
@@ -356,7 +562,7 @@ struct StreamerDummy_HDF5
 	
 	void operate(const int ix, const int iy, const int iz, Real output[9]) const
 	{
-		const FluidElement& input = ref.data[iz][iy][ix];
+		FluidBlock::ConstElementRef input = ref(ix, iy, iz);
 		
 		output[0] = input.rho;
 		//assert(input.rho >= 0);
@@ -370,7 +576,7 @@ struct StreamerDummy_HDF5
 	
 	void operate(const Real output[9], const int ix, const int iy, const int iz) const
 	{
-		FluidElement& input = ref.data[iz][iy][ix];
+		FluidBlock::ElementRef input = ref(ix, iy, iz);
 		
 		input.rho = output[0];
 		//assert(input.rho >= 0);
@@ -402,9 +608,7 @@ struct StreamerFromTemp_HDF5
 
   void operate(const Real output, const int ix, const int iy, const int iz) const
   {
-    FluidElement& input = ref.data[iz][iy][ix];
-
-    input.G = output;
+    ref(ix, iy, iz).G = output;
   }
 	
 	static const char * getAttributeName() { return "Vector"; } 
@@ -420,7 +624,7 @@ StreamerGamma_HDF5(FluidBlock& b): ref(b){}
 
   void operate(const int ix, const int iy, const int iz, Real output[1]) const
   {
-    const FluidElement& input = ref.data[iz][iy][ix];
+    FluidBlock::ConstElementRef input = ref(ix, iy, iz);
 
     output[0] = input.G;
   }
@@ -438,7 +642,7 @@ struct StreamerPressure_HDF5
     
     void operate(const int ix, const int iy, const int iz, Real output[1]) const
     {
-        const FluidElement& input = ref.data[iz][iy][ix];
+        FluidBlock::ConstElementRef input = ref(ix, iy, iz);
         
         output[0] = (input.energy-0.5*(input.u*input.u+input.v*input.v+input.w*input.w)/input.rho - input.P)/input.G;
     }
@@ -456,7 +660,7 @@ struct StreamerPressure_HDF5
         
         void operate(const int ix, const int iy, const int iz, Real output[1]) const
         {
-            const FluidElement& input = ref.data[iz][iy][ix];
+            FluidBlock::ConstElementRef input = ref(ix, iy, iz);
             
             output[0] = input.rho;
         }
@@ -464,7 +668,7 @@ struct StreamerPressure_HDF5
         static const char * getAttributeName() { return "Scalar"; }
     };
 
-typedef Grid<FluidBlock, std::allocator> FluidGridBase;
+typedef Grid<FluidBlock, BlockAllocator> FluidGridBase;
 
 #if 0
 typedef GridMorton<FluidGridBase> FluidGrid;
@@ -1,17 +1,7 @@
 #pragma once
 
 #ifdef _QPXEMU_
-#include <xmmintrin.h>
-#define vector4double __m128
-#define _DIEGO_TRANSPOSE4(a,b,c,d) _MM_TRANSPOSE4_PS(a,b,c,d)
-#define vec_lda(a, b) _mm_load_ps(b + ((a)/4))
-#define vec_sta(a, b, c) _mm_store_ps(c + ((b)/4), a)
-#define vec_mul(a, b) (a) * (b)
-#define vec_sub(a, b) (a) - (b)
-#define vec_add(a, b) (a) + (b)
-#define vec_madd(a, b, c) (a) * (b) + (c)
-#define vec_nmsub(a, b, c) (c) - (a) * (b)
-#define vec_splats(a) _mm_set1_ps(a)
+#include "common.h"
 #endif
 
 #ifndef _DIEGO_TRANSPOSE4